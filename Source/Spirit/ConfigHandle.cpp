@@ -0,0 +1,84 @@
+// - ConfigHandle.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "ConfigHandle.hpp"
+
+// Standard Library
+#include <fstream>
+#include <utility>
+
+// This Project
+#include "PropertyDiff.hpp"
+
+namespace warwick {
+ConfigHandle::ConfigHandle()
+    : current_(std::make_shared<const PropertyList>()),
+      version_(0),
+      notifier_(nullptr),
+      hash_(*current_) {}
+
+ConfigHandle::ConfigHandle(PropertyList document)
+    : current_(std::make_shared<const PropertyList>(std::move(document))),
+      version_(0),
+      notifier_(nullptr),
+      hash_(*current_) {}
+
+bool ConfigHandle::publish(PropertyList document) {
+  Snapshot next(std::make_shared<const PropertyList>(std::move(document)));
+  DocumentHash nextHash(*next);
+  std::lock_guard<std::mutex> lock(publish_);
+  // Unequal hashes reject a changed document at once, but equal ones
+  // may collide, so confirm them by content
+  if (nextHash == hash_ && same_document(*std::atomic_load(&current_), *next)) return false;
+
+  // Snapshot before version, so a Reader that sees the new version
+  // always loads a snapshot at least as new
+  Snapshot previous(notifier_ ? std::atomic_load(&current_) : Snapshot());
+  std::atomic_store(&current_, next);
+  version_.fetch_add(1, std::memory_order_release);
+  if (notifier_) notifier_->update(*previous, hash_, *next, nextHash);
+  hash_ = std::move(nextHash);
+  return true;
+}
+
+void ConfigHandle::set_notifier(ChangeNotifier* notifier) {
+  std::lock_guard<std::mutex> lock(publish_);
+  notifier_ = notifier;
+}
+
+bool ConfigHandle::reload(std::istream& input, ParseErrorList& errors) {
+  PropertyList document;
+  input.unsetf(std::ios::skipws);
+  if (!parse_document(input, document, errors)) return false;
+  publish(std::move(document));
+  return true;
+}
+
+bool ConfigHandle::reload(const std::string& path, ParseErrorList& errors) {
+  std::ifstream input(path);
+  if (!input) {
+    ParseError e;
+    e.line = 0;
+    e.column = 0;
+    e.message = "cannot open \"" + path + "\"";
+    errors.push_back(e);
+    return false;
+  }
+  return reload(input, errors);
+}
+
+std::future<ParseErrorList> ConfigHandle::reload_async(const std::string& path) {
+  return std::async(std::launch::async, [this, path]() {
+    ParseErrorList errors;
+    reload(path, errors);
+    return errors;
+  });
+}
+} // namespace warwick
@@ -0,0 +1,130 @@
+// ConfigHandle - hot-reloadable configuration shared by many threads
+//
+// A ConfigHandle owns the current parsed document as an immutable
+// snapshot. Readers take a shared_ptr to the snapshot and use it for as
+// long as they like, without locks; reloading parses into a new document
+// and swaps it in atomically, so a reader always sees either the old or
+// the new document in full. The old snapshot is freed when its last
+// reader drops it.
+//
+// Taking a snapshot is an atomic shared_ptr load, which in libstdc++
+// takes a (striped) spin lock. Threads that look values up on every
+// request should hold a ConfigHandle::Reader instead: it caches the
+// snapshot and only reloads it when the handle's version has changed,
+// which costs a single atomic load per lookup.
+//
+// A ChangeNotifier attached with set_notifier() is told what changed on
+// every publication, on the publishing thread. Its callbacks must not
+// publish to the same handle.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CONFIGHANDLE_HH
+#define CONFIGHANDLE_HH
+
+// Standard Library
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// This Project
+#include "Property.hpp"
+#include "PropertyHash.hpp"
+#include "PropertyParser.hpp"
+
+namespace warwick {
+class ChangeNotifier;
+
+class ConfigHandle {
+ public:
+  typedef std::shared_ptr<const PropertyList> Snapshot;
+
+  /// Per-thread cached view of a handle
+  class Reader {
+   public:
+    explicit Reader(const ConfigHandle& handle)
+        : handle_(handle), version_(handle.version()), snapshot_(handle.snapshot()) {}
+
+    /// The current document. The reference stays valid until the next
+    /// call to get() or refresh() on this Reader.
+    const PropertyList& get() {
+      if (handle_.version_.load(std::memory_order_acquire) != version_) refresh();
+      return *snapshot_;
+    }
+
+    /// Version of the document last returned by get()
+    std::uint64_t version() const {
+      return version_;
+    }
+
+    void refresh() {
+      version_ = handle_.version();
+      snapshot_ = handle_.snapshot();
+    }
+
+   private:
+    const ConfigHandle& handle_;
+    std::uint64_t version_;
+    Snapshot snapshot_;
+  };
+
+ public:
+  /// Start with an empty document at version 0
+  ConfigHandle();
+
+  explicit ConfigHandle(PropertyList document);
+
+  ConfigHandle(const ConfigHandle&) = delete;
+  ConfigHandle& operator=(const ConfigHandle&) = delete;
+
+  /// The current document
+  Snapshot snapshot() const {
+    return std::atomic_load(&current_);
+  }
+
+  /// Number of documents published since construction
+  std::uint64_t version() const {
+    return version_.load(std::memory_order_acquire);
+  }
+
+  /// Replace the current document, unless it has the same content, in
+  /// which case nothing is published and false is returned
+  bool publish(PropertyList document);
+
+  /// Notify notifier (which must outlive the handle, or be detached by
+  /// passing nullptr) of the changes made by each publication
+  void set_notifier(ChangeNotifier* notifier);
+
+  /// Parse input and publish the result. On error the current document
+  /// is kept, errors holds the problems and false is returned. A document
+  /// with unchanged content parses successfully but is not republished.
+  bool reload(std::istream& input, ParseErrorList& errors);
+
+  /// As above, reading the file at path
+  bool reload(const std::string& path, ParseErrorList& errors);
+
+  /// Reload from path on a background thread. The future holds the
+  /// errors, and is empty if the new document was published.
+  std::future<ParseErrorList> reload_async(const std::string& path);
+
+ private:
+  Snapshot current_;
+  std::atomic<std::uint64_t> version_;
+  ChangeNotifier* notifier_;
+  // Hashes of the current document, guarded by publish_
+  DocumentHash hash_;
+  // Serialises publishers so versions follow publication order
+  std::mutex publish_;
+};
+} // namespace warwick
+
+#endif // CONFIGHANDLE_HH
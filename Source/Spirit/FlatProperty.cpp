@@ -0,0 +1,373 @@
+// - FlatProperty.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "FlatProperty.hpp"
+
+// Standard Library
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <vector>
+
+namespace warwick {
+namespace {
+const char cMagic[8] = {'W', 'P', 'R', 'O', 'P', 'L', 'S', 'T'};
+const std::uint32_t cVersion = 1;
+const std::size_t cHeaderSize = 32;
+const std::size_t cEntrySize = 24;
+
+template <typename T>
+void put(std::string& buffer, std::size_t at, T value) {
+  std::memcpy(&buffer[at], &value, sizeof(value));
+}
+
+template <typename T>
+void append(std::string& buffer, T value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void align(std::string& buffer, std::size_t to) {
+  buffer.append((to - buffer.size() % to) % to, '\0');
+}
+
+std::uint32_t offset(const std::string& buffer) {
+  return static_cast<std::uint32_t>(buffer.size());
+}
+
+std::uint32_t append_string(std::string& buffer, const std::string& s) {
+  const std::uint32_t at = offset(buffer);
+  buffer.append(s);
+  buffer.push_back('\0');
+  return at;
+}
+
+std::uint32_t write_list(const PropertyList& list, std::string& buffer);
+
+/// Appends the out of line data for a value, returning its count and
+/// payload
+class ValueWriter : public boost::static_visitor<std::pair<std::uint32_t, std::uint64_t> > {
+ public:
+  typedef std::pair<std::uint32_t, std::uint64_t> result;
+
+  explicit ValueWriter(std::string& buffer) : buffer_(buffer) {}
+
+  result operator()(int v) const {
+    return result(1, static_cast<std::uint64_t>(static_cast<std::int64_t>(v)));
+  }
+
+  result operator()(double v) const {
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return result(1, bits);
+  }
+
+  result operator()(bool v) const {
+    return result(1, v ? 1 : 0);
+  }
+
+  result operator()(const std::string& v) const {
+    return result(static_cast<std::uint32_t>(v.size()), append_string(buffer_, v));
+  }
+
+  result operator()(const boost::dynamic_bitset<>& v) const {
+    std::vector<std::uint64_t> blocks((v.size() + 63) / 64, 0);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+      if (v[i]) blocks[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+    align(buffer_, 8);
+    const std::uint32_t at = offset(buffer_);
+    for (std::uint64_t b : blocks) append(buffer_, b);
+    return result(static_cast<std::uint32_t>(v.size()), at);
+  }
+
+  result operator()(const std::vector<int>& v) const {
+    align(buffer_, 8);
+    const std::uint32_t at = offset(buffer_);
+    for (int x : v) append(buffer_, static_cast<std::int32_t>(x));
+    return result(static_cast<std::uint32_t>(v.size()), at);
+  }
+
+  result operator()(const std::vector<double>& v) const {
+    align(buffer_, 8);
+    const std::uint32_t at = offset(buffer_);
+    for (double x : v) append(buffer_, x);
+    return result(static_cast<std::uint32_t>(v.size()), at);
+  }
+
+  result operator()(const std::vector<std::string>& v) const {
+    std::vector<std::uint32_t> refs;
+    for (const std::string& s : v) {
+      refs.push_back(append_string(buffer_, s));
+      refs.push_back(static_cast<std::uint32_t>(s.size()));
+    }
+    align(buffer_, 8);
+    const std::uint32_t at = offset(buffer_);
+    for (std::uint32_t r : refs) append(buffer_, r);
+    return result(static_cast<std::uint32_t>(v.size()), at);
+  }
+
+  result operator()(const PropertyList& v) const {
+    return result(static_cast<std::uint32_t>(v.size()), write_list(v, buffer_));
+  }
+
+ private:
+  std::string& buffer_;
+};
+
+std::uint32_t write_list(const PropertyList& list, std::string& buffer) {
+  const std::uint32_t n = static_cast<std::uint32_t>(list.size());
+  align(buffer, 8);
+  const std::uint32_t at = offset(buffer);
+  const std::size_t entries = at + 8;
+  const std::size_t index = entries + cEntrySize * n;
+  buffer.append(8 + cEntrySize * n + 4 * n, '\0');
+  put(buffer, at, n);
+
+  for (std::uint32_t i = 0; i < n; ++i) {
+    const Property& p = list[i];
+    const std::size_t e = entries + cEntrySize * i;
+    put(buffer, e, append_string(buffer, p.Key));
+    put(buffer, e + 4, static_cast<std::uint32_t>(p.Key.size()));
+    put(buffer, e + 8, static_cast<std::uint32_t>(p.Value.which()));
+    const ValueWriter::result r = boost::apply_visitor(ValueWriter(buffer), p.Value);
+    put(buffer, e + 12, r.first);
+    put(buffer, e + 16, r.second);
+  }
+
+  std::vector<std::uint32_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&list](std::uint32_t a, std::uint32_t b) {
+    return list[a].Key < list[b].Key;
+  });
+  for (std::uint32_t i = 0; i < n; ++i) put(buffer, index + 4 * i, order[i]);
+  return at;
+}
+
+template <typename T>
+T get(const char* base, std::uint64_t at) {
+  T value;
+  std::memcpy(&value, base + at, sizeof(value));
+  return value;
+}
+
+/// True if length bytes at offset lie within a buffer of size bytes
+bool fits(std::uint64_t offset, std::uint64_t length, std::size_t size) {
+  return offset <= size && length <= size - offset;
+}
+
+/// Check that the entries of the list at offset, and of every list below
+/// it, only refer to data inside the buffer. flatten() writes each tree
+/// once, after its parent, so a subtree that is shared or does not follow
+/// its parent is corrupt; rejecting those rules out cycles, and lists are
+/// checked from a work list rather than recursively
+bool check_lists(const char* base, std::size_t size, std::uint64_t offset) {
+  std::vector<std::uint64_t> pending(1, offset);
+  std::set<std::uint64_t> seen;
+  while (!pending.empty()) {
+    const std::uint64_t at = pending.back();
+    pending.pop_back();
+    if (!seen.insert(at).second || !fits(at, 8, size)) return false;
+
+    const std::uint32_t n = get<std::uint32_t>(base, at);
+    const std::uint64_t entries = at + 8;
+    const std::uint64_t index = entries + cEntrySize * n;
+    if (!fits(entries, (cEntrySize + 4) * std::uint64_t(n), size)) return false;
+
+    for (std::uint32_t i = 0; i < n; ++i) {
+      if (get<std::uint32_t>(base, index + 4 * i) >= n) return false;
+
+      const std::uint64_t e = entries + cEntrySize * i;
+      const std::uint32_t count = get<std::uint32_t>(base, e + 12);
+      const std::uint64_t payload = get<std::uint64_t>(base, e + 16);
+      if (!fits(get<std::uint32_t>(base, e), get<std::uint32_t>(base, e + 4), size)) {
+        return false;
+      }
+
+      bool valid(true);
+      switch (get<std::uint32_t>(base, e + 8)) {
+        case kInt:
+        case kReal:
+        case kBool:
+          break;
+        case kString:
+          valid = fits(payload, count, size);
+          break;
+        case kBitset:
+          valid = fits(payload, 8 * ((std::uint64_t(count) + 63) / 64), size);
+          break;
+        case kIntArray:
+          valid = fits(payload, 4 * std::uint64_t(count), size);
+          break;
+        case kRealArray:
+          valid = fits(payload, 8 * std::uint64_t(count), size);
+          break;
+        case kStringArray:
+          valid = fits(payload, 8 * std::uint64_t(count), size);
+          for (std::uint32_t j = 0; valid && j < count; ++j) {
+            valid = fits(get<std::uint32_t>(base, payload + 8 * j),
+                         get<std::uint32_t>(base, payload + 8 * j + 4), size);
+          }
+          break;
+        case kTree:
+          valid = payload > at;
+          pending.push_back(payload);
+          break;
+        default:
+          valid = false;
+      }
+      if (!valid) return false;
+    }
+  }
+  return true;
+}
+
+/// Copies a FlatValue out into a Property value
+Property::value_type copy_value(const FlatValue& v) {
+  switch (v.which()) {
+    case kInt:
+      return v.as_int();
+    case kReal:
+      return v.as_real();
+    case kBool:
+      return v.as_bool();
+    case kString:
+      return v.as_string().to_string();
+    case kBitset: {
+      boost::dynamic_bitset<> bits(v.size());
+      for (std::size_t i = 0; i < bits.size(); ++i) bits[i] = v.bit(i);
+      return bits;
+    }
+    case kIntArray: {
+      std::vector<int> a(v.size());
+      for (std::size_t i = 0; i < a.size(); ++i) a[i] = v.int_at(i);
+      return a;
+    }
+    case kRealArray: {
+      std::vector<double> a(v.size());
+      for (std::size_t i = 0; i < a.size(); ++i) a[i] = v.real_at(i);
+      return a;
+    }
+    case kStringArray: {
+      std::vector<std::string> a(v.size());
+      for (std::size_t i = 0; i < a.size(); ++i) a[i] = v.string_at(i).to_string();
+      return a;
+    }
+    default:
+      return v.as_tree().to_list();
+  }
+}
+} // namespace
+
+std::size_t FlatValue::size() const {
+  switch (which()) {
+    case kInt:
+    case kReal:
+    case kBool:
+      return 1;
+    default:
+      return u32(12);
+  }
+}
+
+FlatList FlatValue::as_tree() const {
+  return FlatList(base_, base_ + payload());
+}
+
+Property::value_type FlatValue::to_value() const {
+  return copy_value(*this);
+}
+
+boost::string_ref FlatList::key(std::size_t i) const {
+  std::uint32_t ref[2];
+  std::memcpy(ref, entry(i), sizeof(ref));
+  return boost::string_ref(base_ + ref[0], ref[1]);
+}
+
+bool FlatList::find(boost::string_ref k, FlatValue& value) const {
+  const std::size_t n = size();
+  const char* index = entry(n);
+  auto at = [index](std::size_t i) {
+    std::uint32_t v;
+    std::memcpy(&v, index + 4 * i, sizeof(v));
+    return v;
+  };
+
+  // Last entry with key <= k, which is the last of any equal keys
+  std::size_t lo(0), hi(n);
+  while (lo < hi) {
+    const std::size_t mid = lo + (hi - lo) / 2;
+    if (k < key(at(mid))) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  if (lo == 0 || key(at(lo - 1)) != k) return false;
+  value = this->value(at(lo - 1));
+  return true;
+}
+
+bool FlatList::find_path(boost::string_ref path, FlatValue& value) const {
+  FlatList list(*this);
+  for (;;) {
+    const std::size_t dot = path.find('.');
+    if (!list.find(path.substr(0, dot), value)) return false;
+    if (dot == boost::string_ref::npos) return true;
+    if (value.which() != kTree) return false;
+    list = value.as_tree();
+    path.remove_prefix(dot + 1);
+  }
+}
+
+PropertyList FlatList::to_list() const {
+  PropertyList result;
+  result.reserve(size());
+  for (std::size_t i = 0; i < size(); ++i) {
+    result.push_back(Property{key(i).to_string(), value(i).to_value()});
+  }
+  return result;
+}
+
+bool flatten(const PropertyList& document, std::string& buffer) {
+  buffer.assign(cHeaderSize, '\0');
+  const std::uint32_t root = write_list(document, buffer);
+  align(buffer, 8);
+  // Every offset and count written is less than the final size, so none
+  // was truncated if that fits
+  if (buffer.size() > std::numeric_limits<std::uint32_t>::max()) {
+    buffer.clear();
+    return false;
+  }
+  std::memcpy(&buffer[0], cMagic, sizeof(cMagic));
+  put(buffer, 8, cVersion);
+  put(buffer, 12, std::uint32_t(0));
+  put(buffer, 16, static_cast<std::uint64_t>(buffer.size()));
+  put(buffer, 24, root);
+  return true;
+}
+
+bool open_flat(const void* data, std::size_t size, FlatList& root) {
+  const char* base = static_cast<const char*>(data);
+  if (size < cHeaderSize || std::memcmp(base, cMagic, sizeof(cMagic)) != 0) return false;
+
+  std::uint32_t version, rootOffset;
+  std::uint64_t total;
+  std::memcpy(&version, base + 8, sizeof(version));
+  std::memcpy(&total, base + 16, sizeof(total));
+  std::memcpy(&rootOffset, base + 24, sizeof(rootOffset));
+  if (version != cVersion || total != size || rootOffset + 8 > size) return false;
+
+  if (!check_lists(base, size, rootOffset)) return false;
+
+  root = FlatList(base, base + rootOffset);
+  return true;
+}
+} // namespace warwick
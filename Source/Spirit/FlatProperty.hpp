@@ -0,0 +1,188 @@
+// FlatProperty - position independent, read-only encoding of PropertyLists
+//
+// flatten() encodes a PropertyList into one contiguous buffer that can be
+// written to a file or shared memory segment and used in place, at any
+// address, without parsing or copying. All references inside the buffer
+// are offsets from its start. The layout (native byte order) is
+//
+//   Header   : magic[8], version, flags, size (u64), root list offset
+//   List     : count (u32), pad (u32), count x Entry, count x u32 index
+//   Entry    : key offset, key length, type, count (all u32), payload (u64)
+//
+// Entries are kept in document order, followed by their indices sorted
+// by key, so lookup is a binary search. If a key occurs more than once
+// the last one wins. The meaning of an Entry's count and payload depends
+// on its type, which is the index of the value in Property::value_type:
+//
+//   int, bool       : value in payload
+//   real            : bits of the double in payload
+//   string          : payload is offset of the (NUL terminated) text,
+//                     count its length
+//   bitset          : count bits, in u64 blocks at offset payload
+//   int[], real[]   : count elements (i32/f64) at offset payload
+//   string[]        : count (offset, length) u32 pairs at offset payload
+//   tree            : payload is offset of a List
+//
+// FlatList and FlatValue are lightweight views over a buffer, which must
+// outlive them. Numbers are read with memcpy, so buffers need not be
+// aligned.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef FLATPROPERTY_HH
+#define FLATPROPERTY_HH
+
+// Standard Library
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Third Party
+// - Boost
+#include "boost/utility/string_ref.hpp"
+
+// This Project
+#include "Property.hpp"
+
+namespace warwick {
+class FlatList;
+
+/// View of a single value in a flat buffer
+class FlatValue {
+ public:
+  FlatValue() : base_(nullptr), entry_(nullptr) {}
+  FlatValue(const char* base, const char* entry) : base_(base), entry_(entry) {}
+
+  /// Index of the type in Property::value_type
+  int which() const {
+    return static_cast<int>(u32(8));
+  }
+
+  int as_int() const {
+    return static_cast<int>(static_cast<std::int64_t>(payload()));
+  }
+
+  double as_real() const {
+    double d;
+    const std::uint64_t bits = payload();
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+  }
+
+  bool as_bool() const {
+    return payload() != 0;
+  }
+
+  boost::string_ref as_string() const {
+    return boost::string_ref(base_ + payload(), u32(12));
+  }
+
+  /// Number of array elements, bits of a bitset, or properties of a tree
+  std::size_t size() const;
+
+  int int_at(std::size_t i) const {
+    std::int32_t v;
+    std::memcpy(&v, base_ + payload() + 4 * i, sizeof(v));
+    return v;
+  }
+
+  double real_at(std::size_t i) const {
+    double v;
+    std::memcpy(&v, base_ + payload() + 8 * i, sizeof(v));
+    return v;
+  }
+
+  boost::string_ref string_at(std::size_t i) const {
+    std::uint32_t ref[2];
+    std::memcpy(ref, base_ + payload() + 8 * i, sizeof(ref));
+    return boost::string_ref(base_ + ref[0], ref[1]);
+  }
+
+  bool bit(std::size_t i) const {
+    std::uint64_t block;
+    std::memcpy(&block, base_ + payload() + 8 * (i / 64), sizeof(block));
+    return (block >> (i % 64)) & 1;
+  }
+
+  FlatList as_tree() const;
+
+  /// Copy the value out into a Property value
+  Property::value_type to_value() const;
+
+ private:
+  std::uint32_t u32(std::size_t at) const {
+    std::uint32_t v;
+    std::memcpy(&v, entry_ + at, sizeof(v));
+    return v;
+  }
+
+  std::uint64_t payload() const {
+    std::uint64_t v;
+    std::memcpy(&v, entry_ + 16, sizeof(v));
+    return v;
+  }
+
+ private:
+  const char* base_;
+  const char* entry_;
+};
+
+/// View of a list of properties (the document, or a tree) in a flat buffer
+class FlatList {
+ public:
+  FlatList() : base_(nullptr), list_(nullptr) {}
+  FlatList(const char* base, const char* list) : base_(base), list_(list) {}
+
+  std::size_t size() const {
+    if (!list_) return 0;
+    std::uint32_t n;
+    std::memcpy(&n, list_, sizeof(n));
+    return n;
+  }
+
+  /// Key of the i'th property in document order
+  boost::string_ref key(std::size_t i) const;
+
+  /// Value of the i'th property in document order
+  FlatValue value(std::size_t i) const {
+    return FlatValue(base_, entry(i));
+  }
+
+  /// Find the value of key in this list, returning false if not found
+  bool find(boost::string_ref key, FlatValue& value) const;
+
+  /// Find the value at a dotted path below this list
+  bool find_path(boost::string_ref path, FlatValue& value) const;
+
+  /// Copy the list out into a PropertyList
+  PropertyList to_list() const;
+
+ private:
+  const char* entry(std::size_t i) const {
+    return list_ + 8 + 24 * i;
+  }
+
+ private:
+  const char* base_;
+  const char* list_;
+};
+
+/// Encode document into buffer, replacing its contents, returning false
+/// and leaving buffer empty if the encoding would exceed the 4GiB that
+/// its 32 bit offsets can address
+bool flatten(const PropertyList& document, std::string& buffer);
+
+/// Check that data holds a complete flat buffer of this version, every
+/// offset and count of which lies within size, and if so set root to its
+/// top level list. Buffers from files or shared memory may be corrupt, so
+/// the whole buffer is checked once here, and views over it need not be
+bool open_flat(const void* data, std::size_t size, FlatList& root);
+} // namespace warwick
+
+#endif // FLATPROPERTY_HH
@@ -0,0 +1,131 @@
+// IterativePropertyParser - parse property documents without recursion
+//
+// PropertyListGrammar handles subtrees by recursing through its qi rules,
+// so every level of nesting costs a chain of rule calls and a lot of
+// native stack. Machine generated documents with thousands of levels can
+// exhaust the stack. This parser instead handles the '{' ... '}' structure
+// with an explicit stack of open trees, using qi only for the flat pieces
+// (the "<identifier> :" head of each property and its typed value). It
+// builds the same PropertyList as the recursive grammar, and refuses to
+// nest deeper than a configurable limit.
+//
+// Descriptions are accepted but discarded.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ITERATIVEPROPERTYPARSER_HH
+#define ITERATIVEPROPERTYPARSER_HH
+
+// Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// This Project
+#include "PropertyGrammar.hpp"
+
+namespace warwick {
+template <typename Iterator, typename Skipper>
+class IterativePropertyListParser {
+ public:
+  explicit IterativePropertyListParser(std::size_t maxDepth) : maxDepth_(maxDepth) {
+    head %= qi::omit[-description] >> (identifier > ':');
+    description = "@description" > qi::lexeme['"' >> +(qi::char_ - '"') >> '"'];
+    identifier %= qi::alpha >> *(qi::alnum | qi::char_('_'));
+
+    head.name("property");
+    identifier.name("identifier");
+  }
+
+  /// Parse properties from first into output, stopping at the end of input
+  /// or at input that does not start a property, where first is left.
+  /// Returns false on error, which is recorded in errors.
+  bool parse(Iterator& first,
+             Iterator last,
+             PropertyList& output,
+             ErrorCollector<Iterator>& errors) const {
+    // Open trees, innermost last. The document itself is output
+    std::vector<Frame> stack;
+    auto current = [&]() -> PropertyList& {
+      return stack.empty() ? output : stack.back().list;
+    };
+
+    try {
+      while (true) {
+        qi::skip_over(first, last, skipper);
+
+        if (first == last) {
+          if (stack.empty()) return true;
+          errors.fail(first, "expected \"}\"");
+          return false;
+        }
+
+        if (*first == '}' && !stack.empty()) {
+          // A tree needs at least one property, as for the grammar
+          if (stack.back().list.empty()) {
+            errors.fail(first, "expected <property>");
+            return false;
+          }
+          Property tree;
+          tree.Key = std::move(stack.back().key);
+          tree.Value = std::move(stack.back().list);
+          stack.pop_back();
+          current().push_back(std::move(tree));
+          ++first;
+          continue;
+        }
+
+        Property p;
+        if (!qi::phrase_parse(first, last, head, skipper, p.Key)) {
+          // End of the document's properties, anything left is for the
+          // caller to deal with. Inside a tree, only '}' may follow.
+          if (stack.empty()) return true;
+          errors.fail(first, "expected \"}\"");
+          return false;
+        }
+
+        if (first != last && *first == '{') {
+          if (stack.size() >= maxDepth_) {
+            errors.fail(first, "nesting deeper than " + std::to_string(maxDepth_) + " levels");
+            return false;
+          }
+          ++first;
+          stack.emplace_back();
+          stack.back().key = std::move(p.Key);
+          continue;
+        }
+
+        if (!qi::phrase_parse(first, last, node, skipper, p.Value)) {
+          errors.fail(first, "expected <value>");
+          return false;
+        }
+        current().push_back(std::move(p));
+      }
+    } catch (const qi::expectation_failure<Iterator>& e) {
+      errors.expected(e.first, e.what_);
+    }
+    return false;
+  }
+
+ private:
+  /// An open tree
+  struct Frame {
+    std::string key;
+    PropertyList list;
+  };
+
+  std::size_t maxDepth_;
+  Skipper skipper;
+  qi::rule<Iterator, std::string(), Skipper> head;
+  qi::rule<Iterator, Skipper> description;
+  qi::rule<Iterator, std::string()> identifier;
+  PropertyNodeGrammar<Iterator, Skipper> node;
+};
+} // namespace warwick
+
+#endif // ITERATIVEPROPERTYPARSER_HH
@@ -0,0 +1,64 @@
+// - LineIndex.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "LineIndex.hpp"
+
+// Standard Library
+#include <algorithm>
+#include <cstring>
+
+namespace warwick {
+LineIndex::LineIndex(const char* begin, const char* end)
+    : begin_(begin), end_(end), scanned_(0) {}
+
+LineIndex::LineIndex(const std::string& buffer)
+    : LineIndex(buffer.data(), buffer.data() + buffer.size()) {}
+
+void LineIndex::scan_to(std::size_t offset) {
+  const std::size_t size = static_cast<std::size_t>(end_ - begin_);
+  const std::size_t limit = std::min(offset + 1, size);
+  while (scanned_ < limit) {
+    const void* nl = std::memchr(begin_ + scanned_, '\n', limit - scanned_);
+    if (!nl) {
+      scanned_ = limit;
+      break;
+    }
+    const std::size_t at = static_cast<const char*>(nl) - begin_;
+    newlines_.push_back(at);
+    scanned_ = at + 1;
+  }
+}
+
+std::size_t LineIndex::line_start(std::size_t offset) {
+  scan_to(offset);
+  // First newline at or after offset ends this line, so the one before
+  // that (if any) ends the previous line
+  auto iter = std::lower_bound(newlines_.begin(), newlines_.end(), offset);
+  return iter == newlines_.begin() ? 0 : *(iter - 1) + 1;
+}
+
+TextPosition LineIndex::locate(std::size_t offset) {
+  scan_to(offset);
+  auto iter = std::lower_bound(newlines_.begin(), newlines_.end(), offset);
+  const std::size_t start = iter == newlines_.begin() ? 0 : *(iter - 1) + 1;
+  TextPosition p;
+  p.line = static_cast<std::size_t>(iter - newlines_.begin()) + 1;
+  p.column = offset - start + 1;
+  return p;
+}
+
+std::string LineIndex::line_text(std::size_t offset) {
+  const std::size_t start = line_start(offset);
+  const char* first = begin_ + std::min<std::size_t>(start, end_ - begin_);
+  const char* last = static_cast<const char*>(
+      std::memchr(first, '\n', static_cast<std::size_t>(end_ - first)));
+  return std::string(first, last ? last : end_);
+}
+} // namespace warwick
@@ -0,0 +1,61 @@
+// LineIndex - map offsets in a text buffer to line/column positions
+//
+// Parsing runs on plain buffer iterators, so tracking the line and column
+// as we go (e.g. with spirit's line_pos_iterator) would tax every
+// character of every successful parse. Instead, positions are only
+// resolved when asked for, typically after a failure. The index scans
+// for newlines lazily, only as far as the furthest offset queried so far,
+// and keeps their offsets in a sorted vector that is binary searched.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef LINEINDEX_HH
+#define LINEINDEX_HH
+
+// Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace warwick {
+/// 1-based line and column of an offset in a buffer
+struct TextPosition {
+  std::size_t line;
+  std::size_t column;
+};
+
+class LineIndex {
+ public:
+  /// Construct index over [begin, end). The buffer must outlive the index
+  LineIndex(const char* begin, const char* end);
+
+  /// Construct index over a string. The string must outlive the index
+  explicit LineIndex(const std::string& buffer);
+
+  /// Return line and column of the character at offset
+  TextPosition locate(std::size_t offset);
+
+  /// Return offset of the first character of the line holding offset
+  std::size_t line_start(std::size_t offset);
+
+  /// Return the text of the line holding offset, without the newline
+  std::string line_text(std::size_t offset);
+
+ private:
+  /// Extend the newline index to cover [0, offset]
+  void scan_to(std::size_t offset);
+
+ private:
+  const char* begin_;
+  const char* end_;
+  std::size_t scanned_;
+  std::vector<std::size_t> newlines_;
+};
+} // namespace warwick
+
+#endif // LINEINDEX_HH
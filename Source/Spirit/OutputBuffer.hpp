@@ -0,0 +1,162 @@
+// OutputBuffer - growable text buffer for the property emitters
+//
+// Emitters append text in many small pieces, which is slow through an
+// ostream. OutputBuffer appends to a string instead, and formats numbers
+// directly into it without going through iostreams or locales. When
+// attached to an ostream, the text is handed on in large blocks whenever
+// the buffer fills, so output of any size needs only constant memory.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef OUTPUTBUFFER_HH
+#define OUTPUTBUFFER_HH
+
+// Standard Library
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace warwick {
+class OutputBuffer {
+ public:
+  /// Size at which buffered text is handed to the ostream
+  static const std::size_t cBlockSize = 64 * 1024;
+
+ public:
+  /// Construct buffer appending to text
+  explicit OutputBuffer(std::string& text) : text_(text), os_(nullptr) {}
+
+  /// Construct buffer writing to os
+  explicit OutputBuffer(std::ostream& os) : text_(own_), os_(&os) {
+    own_.reserve(cBlockSize + cBlockSize / 4);
+  }
+
+  ~OutputBuffer() {
+    flush();
+  }
+
+  OutputBuffer(const OutputBuffer&) = delete;
+  OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+  void append(char c) {
+    text_.push_back(c);
+  }
+
+  void append(const char* s, std::size_t n) {
+    text_.append(s, n);
+  }
+
+  void append(const std::string& s) {
+    text_.append(s);
+  }
+
+  /// Append n copies of c
+  void append(std::size_t n, char c) {
+    text_.append(n, c);
+  }
+
+  /// Append decimal representation of value
+  void append_int(long long value) {
+    char digits[24];
+    char* p = digits + sizeof(digits);
+    unsigned long long u = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                     : static_cast<unsigned long long>(value);
+    do {
+      *--p = static_cast<char>('0' + u % 10);
+      u /= 10;
+    } while (u);
+    if (value < 0) *--p = '-';
+    append(p, static_cast<std::size_t>(digits + sizeof(digits) - p));
+  }
+
+  /// Append the shortest decimal representation of value (up to 17
+  /// significant digits) that converts back to exactly the same value.
+  /// If markReal is set, integral values get a ".0" suffix so that
+  /// formats distinguishing integers from reals read them back as reals.
+  void append_real(double value, bool markReal = false) {
+    if (std::isnan(value)) {
+      append("nan", 3);
+      return;
+    }
+    if (std::isinf(value)) {
+      value < 0 ? append("-inf", 4) : append("inf", 3);
+      return;
+    }
+    if (append_short_decimal(value, markReal)) return;
+    char digits[32];
+    int n(0);
+    for (int precision = 15; precision <= 17; ++precision) {
+      n = std::snprintf(digits, sizeof(digits), "%.*g", precision, value);
+      if (precision == 17 || std::strtod(digits, nullptr) == value) break;
+    }
+    append(digits, static_cast<std::size_t>(n));
+    if (markReal && !std::strpbrk(digits, ".e")) append(".0", 2);
+  }
+
+  /// Write buffered text to the ostream if enough has accumulated
+  void maybe_flush() {
+    if (os_ && text_.size() >= cBlockSize) flush();
+  }
+
+  /// Write any buffered text to the ostream
+  void flush() {
+    if (os_ && !text_.empty()) {
+      os_->write(text_.data(), static_cast<std::streamsize>(text_.size()));
+      text_.clear();
+    }
+  }
+
+ private:
+  /// Fast path for the short decimals typical of hand written values:
+  /// find the fewest fractional digits k such that m / 10^k, with m an
+  /// integer below 2^53, is exactly value. Both m and 10^k (k <= 22) are
+  /// exact doubles and division is correctly rounded, so the digits of m
+  /// convert back to value. Restricted to the range printed by %g without
+  /// an exponent.
+  bool append_short_decimal(double value, bool markReal) {
+    const double magnitude = std::fabs(value);
+    if (!(magnitude >= 1e-4 && magnitude < 1e15)) return false;
+    const double cMaxExact = 9007199254740992.0;
+    double scale = 1.0;
+    for (int k = 0; k <= 17; ++k, scale *= 10.0) {
+      const double scaled = std::nearbyint(magnitude * scale);
+      if (scaled >= cMaxExact) return false;
+      if (scaled / scale != magnitude) continue;
+
+      char digits[24];
+      char* end = digits + sizeof(digits);
+      char* p = end;
+      unsigned long long m = static_cast<unsigned long long>(scaled);
+      for (int i = 0; i < k; ++i, m /= 10) {
+        *--p = static_cast<char>('0' + m % 10);
+      }
+      if (k > 0) *--p = '.';
+      do {
+        *--p = static_cast<char>('0' + m % 10);
+        m /= 10;
+      } while (m);
+      if (value < 0) *--p = '-';
+      append(p, static_cast<std::size_t>(end - p));
+      if (markReal && k == 0) append(".0", 2);
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  std::string own_;
+  std::string& text_;
+  std::ostream* os_;
+};
+} // namespace warwick
+
+#endif // OUTPUTBUFFER_HH
@@ -0,0 +1,187 @@
+// - ParseCache.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "ParseCache.hpp"
+
+// Standard Library
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+// POSIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// This Project
+#include "FlatProperty.hpp"
+#include "PerfectHash.hpp"
+
+namespace warwick {
+namespace {
+const char cSuffix[] = ".wprop";
+
+std::atomic<ParseCache*> installed(nullptr);
+
+bool is_entry(const std::string& name) {
+  const std::size_t n = sizeof(cSuffix) - 1;
+  return name.size() > n && name.compare(name.size() - n, n, cSuffix) == 0;
+}
+
+bool read_file(const std::string& file, std::string& text) {
+  std::ifstream input(file, std::ios::binary);
+  if (!input) return false;
+  text.clear();
+  char chunk[64 * 1024];
+  while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0) {
+    text.append(chunk, static_cast<std::size_t>(input.gcount()));
+  }
+  return true;
+}
+
+struct Entry {
+  std::string path;
+  std::uint64_t size;
+  struct timespec modified;
+};
+
+/// Cache entries in directory, with their total size
+std::vector<Entry> list_entries(const std::string& directory, std::uint64_t& total) {
+  std::vector<Entry> entries;
+  total = 0;
+  DIR* dir = ::opendir(directory.c_str());
+  if (!dir) return entries;
+  while (struct dirent* e = ::readdir(dir)) {
+    const std::string name(e->d_name);
+    if (!is_entry(name)) continue;
+    struct stat st;
+    const std::string file = directory + "/" + name;
+    if (::stat(file.c_str(), &st) != 0) continue;
+    entries.push_back(Entry{file, static_cast<std::uint64_t>(st.st_size), st.st_mtim});
+    total += static_cast<std::uint64_t>(st.st_size);
+  }
+  ::closedir(dir);
+  return entries;
+}
+} // namespace
+
+ParseCache::ParseCache(const std::string& directory, std::uint64_t maxBytes)
+    : directory_(directory),
+      maxBytes_(maxBytes),
+      bytes_(0),
+      hits_(0),
+      misses_(0),
+      stores_(0),
+      evictions_(0) {
+  std::uint64_t total(0);
+  list_entries(directory_, total);
+  bytes_ = total;
+}
+
+std::string ParseCache::path(const std::string& text) const {
+  char name[64];
+  std::snprintf(name, sizeof(name), "/%016llx-%llx.v%u",
+                static_cast<unsigned long long>(fnv1a(text.data(), text.size())),
+                static_cast<unsigned long long>(text.size()), cParserVersion);
+  return directory_ + name + cSuffix;
+}
+
+bool ParseCache::load(const std::string& text, PropertyList& output) {
+  const std::string file = path(text);
+  std::string buffer;
+  FlatList root;
+  if (!read_file(file, buffer)) {
+    ++misses_;
+    return false;
+  }
+  // The hash in the name may collide, so only the text stored after the
+  // document identifies the entry
+  if (buffer.size() < text.size() ||
+      buffer.compare(buffer.size() - text.size(), text.size(), text) != 0 ||
+      !open_flat(buffer.data(), buffer.size() - text.size(), root)) {
+    ::unlink(file.c_str());
+    ++misses_;
+    return false;
+  }
+
+  PropertyList document(root.to_list());
+  output.insert(output.end(),
+                std::make_move_iterator(document.begin()),
+                std::make_move_iterator(document.end()));
+  // Refresh the modification time, so eviction is least recently used
+  ::utimensat(AT_FDCWD, file.c_str(), nullptr, 0);
+  ++hits_;
+  return true;
+}
+
+void ParseCache::store(const std::string& text, const PropertyList& document) {
+  std::string buffer;
+  if (!flatten(document, buffer)) return;
+  buffer.append(text);
+
+  // Unique per process and call, so concurrent writers never share a
+  // temporary; the rename is atomic, and the last writer wins
+  static std::atomic<unsigned long> counter(0);
+  const std::string temporary = directory_ + "/.tmp." + std::to_string(::getpid()) + "." +
+                                std::to_string(counter++);
+  {
+    std::ofstream out(temporary, std::ios::binary);
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!out.flush()) {
+      ::unlink(temporary.c_str());
+      return;
+    }
+  }
+  if (std::rename(temporary.c_str(), path(text).c_str()) != 0) {
+    ::unlink(temporary.c_str());
+    return;
+  }
+
+  ++stores_;
+  if ((bytes_ += buffer.size()) > maxBytes_) evict();
+}
+
+void ParseCache::evict() {
+  std::uint64_t total(0);
+  std::vector<Entry> entries = list_entries(directory_, total);
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return a.modified.tv_sec != b.modified.tv_sec ? a.modified.tv_sec < b.modified.tv_sec
+                                                  : a.modified.tv_nsec < b.modified.tv_nsec;
+  });
+
+  const std::uint64_t target = maxBytes_ / 4 * 3;
+  for (const Entry& e : entries) {
+    if (total <= target) break;
+    if (::unlink(e.path.c_str()) == 0) ++evictions_;
+    total -= e.size;
+  }
+  bytes_ = total;
+}
+
+void ParseCache::clear() {
+  std::uint64_t total(0);
+  for (const Entry& e : list_entries(directory_, total)) ::unlink(e.path.c_str());
+  bytes_ = 0;
+}
+
+ParseCache::Statistics ParseCache::statistics() const {
+  return Statistics{hits_, misses_, stores_, evictions_};
+}
+
+void set_parse_cache(ParseCache* cache) {
+  installed = cache;
+}
+
+ParseCache* parse_cache() {
+  return installed;
+}
+} // namespace warwick
@@ -0,0 +1,103 @@
+// ParseCache - persistent on-disk cache of parsed documents
+//
+// Parsing the same unchanged document in every job of a batch is wasted
+// work. A ParseCache stores each successfully parsed document in a
+// directory, in the flat binary form of FlatProperty.hpp followed by the
+// document text, under a name derived from a hash and the length of the
+// text together with cParserVersion. Any process sharing the directory
+// then decodes the stored document instead of parsing the text again,
+// once it has checked that the stored text is the same.
+//
+// The cache is opt-in: install one with set_parse_cache() and the
+// parse_document frontends without descriptions or a schema consult it
+// transparently. Entries are written to a temporary file and renamed
+// into place, so concurrent writers and readers only ever see complete
+// entries; unreadable or corrupt entries count as misses and are
+// removed. When the directory grows beyond its size limit, the least
+// recently used entries (by modification time, which hits refresh) are
+// evicted.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PARSECACHE_HH
+#define PARSECACHE_HH
+
+// Standard Library
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// This Project
+#include "Property.hpp"
+
+namespace warwick {
+/// Version of the grammar and its output. Bump this whenever a change
+/// would parse the same text to a different document, so that stale
+/// entries are never used.
+const unsigned cParserVersion = 1;
+
+class ParseCache {
+ public:
+  struct Statistics {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t stores;
+    std::uint64_t evictions;
+  };
+
+ public:
+  /// Cache in directory (which must exist), holding about maxBytes
+  explicit ParseCache(const std::string& directory,
+                      std::uint64_t maxBytes = 256 * 1024 * 1024);
+
+  ParseCache(const ParseCache&) = delete;
+  ParseCache& operator=(const ParseCache&) = delete;
+
+  const std::string& directory() const {
+    return directory_;
+  }
+
+  /// If the document for text is cached, append it to output and
+  /// return true
+  bool load(const std::string& text, PropertyList& output);
+
+  /// Cache document as the result of parsing text
+  void store(const std::string& text, const PropertyList& document);
+
+  /// Remove least recently used entries until the cache holds at most
+  /// three quarters of its limit
+  void evict();
+
+  /// Remove every entry
+  void clear();
+
+  Statistics statistics() const;
+
+ private:
+  std::string path(const std::string& text) const;
+
+ private:
+  std::string directory_;
+  std::uint64_t maxBytes_;
+  // Estimated size of the directory, corrected by each eviction scan
+  std::atomic<std::uint64_t> bytes_;
+  std::atomic<std::uint64_t> hits_;
+  std::atomic<std::uint64_t> misses_;
+  std::atomic<std::uint64_t> stores_;
+  std::atomic<std::uint64_t> evictions_;
+};
+
+/// Install cache (or none, with nullptr) for use by parse_document.
+/// The cache must stay alive until it is replaced.
+void set_parse_cache(ParseCache* cache);
+
+/// The installed cache, if any
+ParseCache* parse_cache();
+} // namespace warwick
+
+#endif // PARSECACHE_HH
@@ -0,0 +1,183 @@
+// PerfectHash - static hash table built with hash-and-displace
+//
+// For a fixed set of keys known up front (schemas, unit tables, ...) a
+// perfect hash gives lookups with one hash of the key, one probe and one
+// comparison, with no collision chains. Keys are first spread into
+// buckets by their hash. Buckets are then placed largest first, each
+// searching for a displacement d such that mixing d into the hash of every
+// key in the bucket lands them all on free slots. Lookup is then
+//
+//   slot = mix(hash(key), displacement[hash(key) % nBuckets]) % nSlots
+//
+// Keys are hashed through a Traits class, which lets lookups use a
+// different (e.g. non-owning) type to the stored key.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PERFECTHASH_HH
+#define PERFECTHASH_HH
+
+// Standard Library
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Third Party
+// - Boost
+#include "boost/utility/string_ref.hpp"
+
+namespace warwick {
+/// FNV-1a hash of n bytes
+inline std::uint64_t fnv1a(const char* s, std::size_t n) {
+  std::uint64_t h = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < n; ++i) {
+    h ^= static_cast<unsigned char>(s[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+/// Default traits, for string keys looked up by anything convertible
+/// to boost::string_ref
+template <typename Key>
+struct PerfectHashTraits {
+  static std::uint64_t hash(boost::string_ref key) {
+    return fnv1a(key.data(), key.size());
+  }
+
+  static bool equal(const Key& stored, boost::string_ref key) {
+    return boost::string_ref(stored) == key;
+  }
+};
+
+template <typename Key, typename Value, typename Traits = PerfectHashTraits<Key> >
+class PerfectHash {
+ public:
+  typedef std::pair<Key, Value> entry_type;
+
+ public:
+  /// Build the table from entries, returning false if any key is
+  /// duplicated, or two keys have the same hash. Key and Value must be
+  /// default constructible.
+  bool build(std::vector<entry_type> entries) {
+    const std::size_t n = entries.size();
+    std::vector<std::uint64_t> hashes(n);
+    for (std::size_t i = 0; i < n; ++i) hashes[i] = Traits::hash(entries[i].first);
+
+    // Keys with the same hash always share a bucket and displacement, so
+    // can never be separated whether or not they are equal. Check up front
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&hashes](std::size_t a, std::size_t b) {
+      return hashes[a] < hashes[b];
+    });
+    for (std::size_t i = 1; i < n; ++i) {
+      if (hashes[order[i]] == hashes[order[i - 1]]) return false;
+    }
+
+    // Minimal table if it can be found quickly, otherwise allow some
+    // slack. Distinct hashes are placed long before the limit, which only
+    // guards against a hash that differs in too few bits
+    const std::size_t cMaxSlots = 4 * n + 64;
+    for (std::size_t nSlots = std::max<std::size_t>(n, 1); nSlots <= cMaxSlots;
+         nSlots += nSlots / 8 + 1) {
+      if (place(entries, hashes, nSlots)) return true;
+    }
+    return false;
+  }
+
+  /// Return the value for key, or nullptr if it is not in the table
+  template <typename K>
+  const Value* find(const K& key) const {
+    if (slots_.empty()) return nullptr;
+    const std::uint64_t h = Traits::hash(key);
+    const std::uint64_t d = displacements_[h % displacements_.size()];
+    const std::size_t slot = mix(h, d) % slots_.size();
+    const entry_type& e = slots_[slot];
+    return used_[slot] && Traits::equal(e.first, key) ? &e.second : nullptr;
+  }
+
+  /// Number of slots, which is at least the number of keys
+  std::size_t capacity() const {
+    return slots_.size();
+  }
+
+ private:
+  static std::uint64_t mix(std::uint64_t h, std::uint64_t d) {
+    h ^= d * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  /// Try to place all entries into nSlots slots
+  bool place(std::vector<entry_type>& entries,
+             const std::vector<std::uint64_t>& hashes,
+             std::size_t nSlots) {
+    const std::size_t n = entries.size();
+    const std::size_t nBuckets = std::max<std::size_t>(n / 2, 1);
+    std::vector<std::vector<std::size_t> > buckets(nBuckets);
+    for (std::size_t i = 0; i < n; ++i) buckets[hashes[i] % nBuckets].push_back(i);
+
+    std::vector<std::size_t> order(nBuckets);
+    for (std::size_t b = 0; b < nBuckets; ++b) order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&buckets](std::size_t a, std::size_t b) {
+      return buckets[a].size() > buckets[b].size();
+    });
+
+    const std::size_t cMaxAttempts = 64 * nSlots + 1024;
+    std::vector<std::uint64_t> displacements(nBuckets, 0);
+    std::vector<std::size_t> owner(nSlots, n);
+    std::vector<std::size_t> taken;
+    for (std::size_t b : order) {
+      if (buckets[b].empty()) break;
+      bool placed = false;
+      for (std::uint64_t d = 0; d < cMaxAttempts && !placed; ++d) {
+        taken.clear();
+        placed = true;
+        for (std::size_t i : buckets[b]) {
+          std::size_t slot = mix(hashes[i], d) % nSlots;
+          if (owner[slot] != n ||
+              std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+            placed = false;
+            break;
+          }
+          taken.push_back(slot);
+        }
+        if (placed) {
+          displacements[b] = d;
+          for (std::size_t k = 0; k < taken.size(); ++k) owner[taken[k]] = buckets[b][k];
+        }
+      }
+      if (!placed) return false;
+    }
+
+    slots_.clear();
+    slots_.resize(nSlots);
+    used_.assign(nSlots, false);
+    for (std::size_t s = 0; s < nSlots; ++s) {
+      if (owner[s] == n) continue;
+      slots_[s] = std::move(entries[owner[s]]);
+      used_[s] = true;
+    }
+    displacements_.swap(displacements);
+    return true;
+  }
+
+ private:
+  std::vector<std::uint64_t> displacements_;
+  std::vector<entry_type> slots_;
+  std::vector<bool> used_;
+};
+} // namespace warwick
+
+#endif // PERFECTHASH_HH
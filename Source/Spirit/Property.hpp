@@ -10,13 +10,17 @@
 #ifndef PROPERTY_HH
 #define PROPERTY_HH
 // Standard Library
+#include <map>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 // Third Party
 // - Boost
 #include "boost/variant.hpp"
 #include "boost/dynamic_bitset.hpp"
+#include "boost/mpl/at.hpp"
+#include "boost/mpl/size.hpp"
 
 namespace warwick {
 struct Property;
@@ -63,9 +67,45 @@ struct Property {
   };
 };
 
+/// Index of each type in Property::value_type, as returned by which()
+enum ValueIndex {
+  kInt = 0,
+  kReal,
+  kBool,
+  kString,
+  kBitset,
+  kIntArray,
+  kRealArray,
+  kStringArray,
+  kTree
+};
+
+namespace detail {
+template <ValueIndex I, typename T>
+struct is_value_index
+    : std::is_same<typename boost::mpl::at_c<Property::value_type::types, I>::type, T> {};
+} // namespace detail
+
+static_assert(boost::mpl::size<Property::value_type::types>::value == kTree + 1 &&
+                  detail::is_value_index<kInt, int>::value &&
+                  detail::is_value_index<kReal, double>::value &&
+                  detail::is_value_index<kBool, bool>::value &&
+                  detail::is_value_index<kString, std::string>::value &&
+                  detail::is_value_index<kBitset, boost::dynamic_bitset<> >::value &&
+                  detail::is_value_index<kIntArray, std::vector<int> >::value &&
+                  detail::is_value_index<kRealArray, std::vector<double> >::value &&
+                  detail::is_value_index<kStringArray, std::vector<std::string> >::value &&
+                  detail::is_value_index<kTree, PropertyList>::value,
+              "ValueIndex must follow the order of Property::value_type");
+
+/// Side table of "@description" texts, keyed by the dotted path of the
+/// property they describe (e.g. "baz.b.alpha"). Held separately from
+/// Property so that nodes stay small, and only filled when requested.
+typedef std::map<Property::key_type, std::string> PropertyDescriptions;
+
 
 // Output streams for convenience
-std::ostream& operator<<(std::ostream& os, const warwick::Property& p) {
+inline std::ostream& operator<<(std::ostream& os, const warwick::Property& p) {
   // need a vistor for sequence types
   os << "[" << "key: " << p.Key << "," << "value[" << p.Value.which() << "]: ";
   boost::apply_visitor(warwick::Property::ostream_visitor(os),p.Value);
@@ -73,7 +113,7 @@ std::ostream& operator<<(std::ostream& os, const warwick::Property& p) {
   return os;
 }
 
-std::ostream& operator<<(std::ostream& os, const warwick::PropertyList& d) {
+inline std::ostream& operator<<(std::ostream& os, const warwick::PropertyList& d) {
   warwick::PropertyList::const_iterator iter = d.begin();
   warwick::PropertyList::const_iterator end = d.end();
   while (iter != end) {
@@ -0,0 +1,256 @@
+// - PropertyCST.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyCST.hpp"
+
+// Standard Library
+#include <iterator>
+#include <sstream>
+
+// This Project
+#include "PropertyGrammar.hpp"
+#include "LineIndex.hpp"
+
+namespace warwick {
+namespace {
+typedef std::string::const_iterator Iterator;
+typedef PropertySkipper<Iterator> Skipper;
+
+/// Scanner for the tokens of a document. Like the iterative parser, it
+/// tracks nesting with an explicit stack, but records where each token
+/// lies rather than building values. Typed values are checked with the
+/// node grammar so that the CST only accepts valid documents.
+class CSTBuilder {
+ public:
+  CSTBuilder(const std::string& source,
+             std::vector<PropertyCST::Entry>& entries,
+             std::vector<TextSpan>& trivia)
+      : source_(source), entries_(entries), trivia_(trivia) {
+    identifier %= qi::alpha >> *(qi::alnum | qi::char_('_'));
+    // A type name, with the dimension of a quantity, "real as length"
+    typename_ %= qi::raw[+qi::alpha >> -(+qi::blank >> "as" >> +qi::blank >> identifier)];
+    quotedstring = '"' >> +(qi::char_ - '"') >> '"';
+  }
+
+  /// Scan the source, returning false and setting where/message on error
+  bool build(Iterator& where, std::string& message) {
+    Iterator first(source_.begin());
+    Iterator last(source_.end());
+    std::string prefix;
+    std::vector<std::size_t> open;   // entries of open trees
+    std::vector<std::size_t> marks;  // prefix lengths of open trees
+
+    auto fail = [&](const std::string& m) {
+      where = first;
+      message = m;
+      return false;
+    };
+
+    try {
+      while (true) {
+        skip(first, last);
+
+        if (first == last) {
+          return open.empty() ? true : fail("expected \"}\"");
+        }
+
+        if (*first == '}') {
+          if (open.empty()) return fail("expected <property>");
+          if (entries_.size() == open.back() + 1) return fail("expected <property>");
+          TextSpan& value = entries_[open.back()].value;
+          value.length = offset(first) + 1 - value.offset;
+          prefix.resize(marks.back());
+          marks.pop_back();
+          open.pop_back();
+          ++first;
+          continue;
+        }
+
+        PropertyCST::Entry e = PropertyCST::Entry();
+        if (*first == '@') {
+          Iterator start(first);
+          if (!qi::parse(first, last, qi::lit("@description"))) {
+            return fail("expected <property>");
+          }
+          skip(first, last);
+          if (!qi::parse(first, last, quotedstring)) {
+            return fail("expected <quoted string>");
+          }
+          e.description = span(start, first);
+          skip(first, last);
+        }
+
+        Iterator keyStart(first);
+        std::string key;
+        if (!qi::parse(first, last, identifier, key)) {
+          return fail("expected <identifier>");
+        }
+        e.key = span(keyStart, first);
+        e.path = prefix + key;
+
+        skip(first, last);
+        if (first == last || *first != ':') return fail("expected \":\"");
+        ++first;
+        skip(first, last);
+
+        if (first != last && *first == '{') {
+          e.value.offset = offset(first);
+          open.push_back(entries_.size());
+          marks.push_back(prefix.size());
+          prefix += key;
+          prefix += '.';
+          entries_.push_back(std::move(e));
+          ++first;
+          continue;
+        }
+
+        // Find the value's start, then check the whole "type = value"
+        // with the node grammar, which also gives the value's end
+        Iterator typeStart(first);
+        if (!qi::parse(first, last, typename_, e.type)) {
+          return fail("expected <value>");
+        }
+        skip(first, last);
+        if (first == last || *first != '=') return fail("expected \"=\"");
+        ++first;
+        skip(first, last);
+        Iterator valueStart(first);
+
+        first = typeStart;
+        Property::value_type dummy;
+        if (!qi::phrase_parse(first, last, node, skipper, qi::skip_flag::dont_postskip, dummy)) {
+          first = typeStart;
+          return fail("expected <typed value>");
+        }
+        e.value = span(valueStart, first);
+        entries_.push_back(std::move(e));
+      }
+    } catch (const qi::expectation_failure<Iterator>& x) {
+      std::ostringstream os;
+      os << "expected " << x.what_;
+      first = x.first;
+      return fail(os.str());
+    }
+  }
+
+ private:
+  std::size_t offset(Iterator i) const {
+    return static_cast<std::size_t>(i - source_.begin());
+  }
+
+  TextSpan span(Iterator b, Iterator e) const {
+    TextSpan s;
+    s.offset = offset(b);
+    s.length = static_cast<std::size_t>(e - b);
+    return s;
+  }
+
+  /// Skip whitespace/comments, recording the range as trivia
+  void skip(Iterator& first, Iterator last) {
+    Iterator start(first);
+    qi::skip_over(first, last, skipper);
+    if (first != start) trivia_.push_back(span(start, first));
+  }
+
+ private:
+  const std::string& source_;
+  std::vector<PropertyCST::Entry>& entries_;
+  std::vector<TextSpan>& trivia_;
+  Skipper skipper;
+  qi::rule<Iterator, std::string()> identifier;
+  qi::rule<Iterator, std::string()> typename_;
+  qi::rule<Iterator> quotedstring;
+  PropertyNodeGrammar<Iterator, Skipper> node;
+};
+
+/// Check that text is a valid value of type
+bool valid_value(const std::string& type, const std::string& text) {
+  const std::string typed = type + " = " + text;
+  Iterator first(typed.begin());
+  Iterator last(typed.end());
+  PropertyNodeGrammar<Iterator, Skipper> node;
+  Property::value_type dummy;
+  try {
+    return qi::phrase_parse(first, last, node, Skipper(), dummy) && first == last;
+  } catch (const qi::expectation_failure<Iterator>&) {
+    return false;
+  }
+}
+} // namespace
+
+bool PropertyCST::parse(const std::string& text, ParseError& error) {
+  source_ = text;
+  entries_.clear();
+  index_.clear();
+  trivia_.clear();
+  edits_.clear();
+
+  Iterator where(source_.begin());
+  std::string message;
+  if (!CSTBuilder(source_, entries_, trivia_).build(where, message)) {
+    TextPosition pos = LineIndex(source_).locate(
+        static_cast<std::size_t>(where - source_.begin()));
+    error.line = pos.line;
+    error.column = pos.column;
+    error.message = message;
+    entries_.clear();
+    trivia_.clear();
+    return false;
+  }
+
+  // The last of any duplicated keys wins, as for every other reader
+  for (std::size_t i = 0; i < entries_.size(); ++i) index_[entries_[i].path] = i;
+  return true;
+}
+
+bool PropertyCST::parse(std::istream& input, ParseError& error) {
+  return parse(std::string((std::istreambuf_iterator<char>(input)),
+                           std::istreambuf_iterator<char>()),
+               error);
+}
+
+const PropertyCST::Entry* PropertyCST::find(const std::string& path) const {
+  auto iter = index_.find(path);
+  return iter == index_.end() ? nullptr : &entries_[iter->second];
+}
+
+std::string PropertyCST::value_text(const std::string& path) const {
+  const Entry* e = find(path);
+  if (!e) return std::string();
+  auto edit = edits_.find(e->value.offset);
+  if (edit != edits_.end()) return edit->second.text;
+  return source_.substr(e->value.offset, e->value.length);
+}
+
+bool PropertyCST::set_value(const std::string& path, const std::string& text) {
+  const Entry* e = find(path);
+  if (!e || e->type.empty() || !valid_value(e->type, text)) return false;
+  Edit& edit = edits_[e->value.offset];
+  edit.length = e->value.length;
+  edit.text = text;
+  return true;
+}
+
+void PropertyCST::write(std::ostream& os) const {
+  std::size_t pos(0);
+  for (const auto& edit : edits_) {
+    os.write(source_.data() + pos, static_cast<std::streamsize>(edit.first - pos));
+    os.write(edit.second.text.data(), static_cast<std::streamsize>(edit.second.text.size()));
+    pos = edit.first + edit.second.length;
+  }
+  os.write(source_.data() + pos, static_cast<std::streamsize>(source_.size() - pos));
+}
+
+std::string PropertyCST::str() const {
+  std::ostringstream os;
+  write(os);
+  return os.str();
+}
+} // namespace warwick
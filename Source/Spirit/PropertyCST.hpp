@@ -0,0 +1,109 @@
+// PropertyCST - lossless concrete syntax tree for property documents
+//
+// A PropertyList keeps only keys and values, so rewriting a document
+// through it loses comments and layout. The CST instead keeps the source
+// text, and records where each property's key, type and value lie in it,
+// along with the trivia (whitespace and comments) between tokens. Values
+// can be replaced by path, the edit being held as an overlay on the
+// source rather than applied to it. Writing the document copies the
+// unchanged ranges in bulk and splices in the edits, so its cost scales
+// with the number of edits rather than with the size of the document.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYCST_HH
+#define PROPERTYCST_HH
+
+// Standard Library
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+// This Project
+#include "PropertyParser.hpp"
+
+namespace warwick {
+/// Byte range [offset, offset+length) of the source text
+struct TextSpan {
+  std::size_t offset;
+  std::size_t length;
+};
+
+class PropertyCST {
+ public:
+  /// Location of each part of a property in the source text.
+  /// For trees, type is empty and value spans the braces. For
+  /// quantities, type includes the dimension, e.g. "real as length".
+  /// Spans that are not present have zero length.
+  struct Entry {
+    std::string path;
+    std::string type;
+    TextSpan description;
+    TextSpan key;
+    TextSpan value;
+  };
+
+ public:
+  /// Build the tree from text, returning false and filling error if the
+  /// text is not a valid document
+  bool parse(const std::string& text, ParseError& error);
+
+  /// Build the tree from the contents of input
+  bool parse(std::istream& input, ParseError& error);
+
+  /// Return entries for all properties, in document order
+  const std::vector<Entry>& entries() const {
+    return entries_;
+  }
+
+  /// Return ranges of whitespace and comments between tokens
+  const std::vector<TextSpan>& trivia() const {
+    return trivia_;
+  }
+
+  /// Return entry for dotted path, or nullptr if there is none. If the
+  /// path occurs more than once this is the last, which takes effect
+  const Entry* find(const std::string& path) const;
+
+  /// Return the current text of the value at path, including edits
+  std::string value_text(const std::string& path) const;
+
+  /// Replace the text of the terminal value at path. The new text must
+  /// be a valid value for the property's type, e.g. "[1, 2]" for an int
+  /// array. Returns false, leaving the tree unchanged, otherwise.
+  bool set_value(const std::string& path, const std::string& text);
+
+  /// Return number of values currently edited
+  std::size_t edit_count() const {
+    return edits_.size();
+  }
+
+  /// Write the document, including edits, to os
+  void write(std::ostream& os) const;
+
+  /// Return the document, including edits, as a string
+  std::string str() const;
+
+ private:
+  /// A replacement of the source span starting at the map key
+  struct Edit {
+    std::size_t length;
+    std::string text;
+  };
+
+  std::string source_;
+  std::vector<Entry> entries_;
+  std::map<std::string, std::size_t> index_;
+  std::vector<TextSpan> trivia_;
+  std::map<std::size_t, Edit> edits_;
+};
+} // namespace warwick
+
+#endif // PROPERTYCST_HH
@@ -8,15 +8,103 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+// Usage:
+//
+//   PropertyChecker                 interactive, one property per line
+//   PropertyChecker <file>          check one document, printing it
+//   PropertyChecker --batch [-j N] [--schema <file>] [--ext <.ext>]...
+//                   <file|dir>...   check many documents in parallel
+//   PropertyChecker --watch [-j N] [--schema <file>] [--ext <.ext>]...
+//                   <dir>...        check, then recheck files as they change
+//   PropertyChecker --daemon <socket> [--cache N]
+//                                   serve requests, see PropertyDaemon.hpp
+//   PropertyChecker --emit-cpp <file> [--name <id>] [--namespace <ns>]
+//                   [-o <header>]   compile to a constexpr header, see
+//                                   PropertyCpp.hpp
+//
+// Directories are walked recursively, optionally only checking files
+// with the given extensions.
+
 // Standard Library
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 
 // This Project
 #include "PropertyCheckerInterfaces.hpp"
 
-int main(int /*argc*/, const char *argv[])
+namespace {
+int usage() {
+  std::cerr << "usage: PropertyChecker [<file> | (--batch | --watch) [-j N]"
+               " [--schema <file>] [--ext <.ext>]... <file|dir>...\n"
+               "                       | --daemon <socket> [--cache N]\n"
+               "                       | --emit-cpp <file> [--name <id>] [--namespace <ns>]"
+               " [-o <header>]]" << std::endl;
+  return 2;
+}
+
+int run_batch(int argc, const char* argv[], bool watch) {
+  BatchOptions options;
+  for (int i = 2; i < argc; ++i) {
+    const bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "-j") == 0 && hasValue) {
+      const long jobs = std::atol(argv[++i]);
+      if (jobs < 1) return usage();
+      options.jobs = static_cast<std::size_t>(jobs);
+    } else if (std::strcmp(argv[i], "--schema") == 0 && hasValue) {
+      options.schema = argv[++i];
+    } else if (std::strcmp(argv[i], "--ext") == 0 && hasValue) {
+      options.extensions.push_back(argv[++i]);
+    } else if (argv[i][0] == '-') {
+      return usage();
+    } else {
+      options.paths.push_back(argv[i]);
+    }
+  }
+  if (options.paths.empty()) return usage();
+  return watch ? watch_main(options) : batch_main(options);
+}
+
+int run_daemon(int argc, const char* argv[]) {
+  if (argc != 3 && !(argc == 5 && std::strcmp(argv[3], "--cache") == 0)) return usage();
+  const long entries = argc == 5 ? std::atol(argv[4]) : 4096;
+  if (entries < 1) return usage();
+  return daemon_main(argv[2], static_cast<std::size_t>(entries));
+}
+
+int run_emit_cpp(int argc, const char* argv[]) {
+  EmitOptions options;
+  for (int i = 2; i < argc; ++i) {
+    const bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--name") == 0 && hasValue) {
+      options.name = argv[++i];
+    } else if (std::strcmp(argv[i], "--namespace") == 0 && hasValue) {
+      options.nameSpace = argv[++i];
+    } else if (std::strcmp(argv[i], "-o") == 0 && hasValue) {
+      options.output = argv[++i];
+    } else if (argv[i][0] == '-' || !options.input.empty()) {
+      return usage();
+    } else {
+      options.input = argv[i];
+    }
+  }
+  if (options.input.empty()) return usage();
+  return emit_cpp_main(options);
+}
+}
+
+int main(int argc, const char *argv[])
 {
   int result(0);
-  if (argv[1]) {
+  if (argc > 1 && std::strcmp(argv[1], "--batch") == 0) {
+    result = run_batch(argc, argv, false);
+  } else if (argc > 1 && std::strcmp(argv[1], "--watch") == 0) {
+    result = run_batch(argc, argv, true);
+  } else if (argc > 1 && std::strcmp(argv[1], "--daemon") == 0) {
+    result = run_daemon(argc, argv);
+  } else if (argc > 1 && std::strcmp(argv[1], "--emit-cpp") == 0) {
+    result = run_emit_cpp(argc, argv);
+  } else if (argv[1]) {
     result = filereader_main(argv[1]);
   } else {
     result = cli_main();
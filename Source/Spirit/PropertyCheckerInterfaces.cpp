@@ -7,31 +7,66 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+// Ourselves
+#include "PropertyCheckerInterfaces.hpp"
+
 // Standard Library
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+
+// POSIX
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 // Third Party
-// - A
+// - Boost
+#include "boost/filesystem.hpp"
 
 // This Project
+#include "PropertyCpp.hpp"
+#include "PropertyDaemon.hpp"
 #include "PropertyParser.hpp"
+#include "Schema.hpp"
 
 int filereader_main(const char* filename) {
   std::ifstream input(filename);
   input.unsetf(std::ios::skipws);
 
   warwick::PropertyList config;
+  warwick::PropertyDescriptions descriptions;
+  warwick::ParseErrorList errors;
 
-  if (parse_document(input, config)) {
+  if (parse_document(input, config, descriptions, errors)) {
     std::cout << "Successful parse of \"" << filename << "\"" << std::endl;
     std::cout << "Document = " << config << std::endl;
+    if (!descriptions.empty()) {
+      std::cout << "Descriptions:" << std::endl;
+      for (const auto& d : descriptions) {
+        std::cout << "  " << d.first << " : " << d.second << std::endl;
+      }
+    }
     return 0;
   } else {
     // NB, even failure may leave us with a partially config object...
     // for example, key may have been set but nothing else.
     std::cerr << "Failed to parse \"" << filename << "\"" << std::endl;
+    for (const auto& e : errors) {
+      std::cerr << filename << ":" << e.line << ":" << e.column << ": "
+                << e.message << std::endl;
+    }
     return 1;
   }
 }
@@ -66,3 +101,471 @@ int cli_main() {
   return 0;
 }
 
+
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// Outcome of checking one file. A hash of the text is kept so that
+/// watch mode can tell when a file really changed; the document itself is
+/// not, as nothing reads it and a large tree holds thousands of them.
+struct FileResult {
+  bool ok = false;
+  double ms = 0.0;
+  std::uint64_t hash = 0;
+  std::vector<std::string> messages;
+};
+
+bool wanted_file(const BatchOptions& options, const boost::filesystem::path& p) {
+  return options.extensions.empty() ||
+         std::find(options.extensions.begin(), options.extensions.end(),
+                   p.extension().string()) != options.extensions.end();
+}
+
+/// Append the files under directory to files, in sorted order
+bool walk_directory(const BatchOptions& options,
+                    const std::string& directory,
+                    std::vector<std::string>& files) {
+  namespace fs = boost::filesystem;
+  boost::system::error_code ec;
+  std::vector<std::string> found;
+  fs::recursive_directory_iterator iter(directory, ec), end;
+  for (; !ec && iter != end; iter.increment(ec)) {
+    if (fs::is_regular_file(iter->status()) && wanted_file(options, iter->path())) {
+      found.push_back(iter->path().string());
+    }
+  }
+  if (ec) {
+    std::cerr << "error: cannot walk \"" << directory << "\": " << ec.message() << std::endl;
+    return false;
+  }
+  // Directory order is unspecified, so sort for reproducible output
+  std::sort(found.begin(), found.end());
+  files.insert(files.end(), found.begin(), found.end());
+  return true;
+}
+
+/// Expand the batch paths into the list of files to check. Explicit
+/// files are always included, directories are walked recursively
+bool collect_files(const BatchOptions& options, std::vector<std::string>& files) {
+  for (const std::string& path : options.paths) {
+    boost::system::error_code ec;
+    if (boost::filesystem::is_directory(path, ec)) {
+      if (!walk_directory(options, path, files)) return false;
+    } else {
+      files.push_back(path);
+    }
+  }
+  return true;
+}
+
+bool load_schema(const std::string& filename, warwick::Schema& schema) {
+  std::ifstream input(filename);
+  input.unsetf(std::ios::skipws);
+  std::string error;
+  if (!input || !schema.read(input, error)) {
+    std::cerr << "error: invalid schema \"" << filename << "\": "
+              << (input ? error : "cannot open file") << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/// Check filename, reusing previous (if given) when the text still has
+/// its hash rather than parsing it again
+FileResult check_file(const std::string& filename,
+                      const warwick::Schema* schema,
+                      const FileResult* previous) {
+  FileResult result;
+  const Clock::time_point start = Clock::now();
+
+  std::ifstream file(filename);
+  if (!file) {
+    result.messages.push_back(filename + ": cannot open file");
+  } else {
+    const std::string text((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+    result.hash = warwick::fnv1a(text.data(), text.size());
+    if (previous && previous->hash == result.hash) {
+      result = *previous;
+      result.ms = elapsed_ms(start);
+      return result;
+    }
+    std::istringstream input(text);
+    input.unsetf(std::ios::skipws);
+    warwick::PropertyList document;
+    warwick::ParseErrorList errors;
+    result.ok = schema ? parse_document(input, document, *schema, errors)
+                       : parse_document(input, document, errors);
+    for (const auto& e : errors) {
+      result.messages.push_back(filename + ":" + std::to_string(e.line) + ":" +
+                                std::to_string(e.column) + ": " + e.message);
+    }
+  }
+
+  result.ms = elapsed_ms(start);
+  return result;
+}
+
+/// Check files on up to jobs threads, returning the number of threads
+/// used. Workers claim files through a shared counter, so the load
+/// balances however uneven the file sizes are. Each result has its own
+/// slot, so no further synchronization is needed. Files with an entry in
+/// known whose hash still matches reuse it instead of being parsed.
+std::size_t check_files(const std::vector<std::string>& files,
+                        const warwick::Schema* schema,
+                        std::size_t jobs,
+                        std::vector<FileResult>& results,
+                        const std::map<std::string, FileResult>* known = nullptr) {
+  results.clear();
+  results.resize(files.size());
+  std::atomic<std::size_t> next(0);
+  auto worker = [&]() {
+    for (std::size_t i = next++; i < files.size(); i = next++) {
+      const FileResult* previous(nullptr);
+      if (known) {
+        auto k = known->find(files[i]);
+        if (k != known->end()) previous = &k->second;
+      }
+      results[i] = check_file(files[i], schema, previous);
+    }
+  };
+
+  if (!jobs) jobs = std::thread::hardware_concurrency();
+  jobs = std::max<std::size_t>(1, std::min(jobs, files.size()));
+  std::vector<std::thread> pool;
+  for (std::size_t j = 1; j < jobs; ++j) pool.emplace_back(worker);
+  worker();
+  for (std::thread& t : pool) t.join();
+  return jobs;
+}
+
+void print_result(const std::string& filename, const FileResult& r) {
+  std::cout << (r.ok ? "OK   " : "FAIL ") << r.ms << " ms  " << filename << "\n";
+  for (const std::string& m : r.messages) std::cerr << "  " << m << "\n";
+}
+} // namespace
+
+int batch_main(const BatchOptions& options) {
+  const Clock::time_point start = Clock::now();
+
+  warwick::Schema schema;
+  if (!options.schema.empty() && !load_schema(options.schema, schema)) return 2;
+  const warwick::Schema* schemaPtr = options.schema.empty() ? nullptr : &schema;
+
+  std::vector<std::string> files;
+  if (!collect_files(options, files)) return 2;
+
+  std::vector<FileResult> results;
+  const std::size_t jobs = check_files(files, schemaPtr, options.jobs, results);
+
+  std::size_t failed(0);
+  double busy(0.0);
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    print_result(files[i], results[i]);
+    failed += results[i].ok ? 0 : 1;
+    busy += results[i].ms;
+  }
+
+  const double wall = elapsed_ms(start);
+  std::cout << "\n" << files.size() << " files, " << files.size() - failed << " passed, "
+            << failed << " failed\n"
+            << jobs << " jobs, " << wall << " ms wall, " << busy << " ms in parsers";
+  if (wall > 0) std::cout << ", " << files.size() / (wall / 1000.0) << " files/s";
+  std::cout << std::endl;
+  return failed ? 1 : 0;
+}
+
+#ifdef __linux__
+namespace {
+/// State of a watched tree: the last result for every file, keyed by
+/// path, plus the inotify watches on its directories
+class Watcher {
+ public:
+  explicit Watcher(const BatchOptions& options) : options_(options) {}
+
+  ~Watcher() {
+    if (fd_ >= 0) close(fd_);
+  }
+
+  /// Check everything once and set up the watches
+  bool start() {
+    fd_ = inotify_init1(IN_CLOEXEC);
+    if (fd_ < 0) {
+      std::cerr << "error: inotify_init1: " << std::strerror(errno) << std::endl;
+      return false;
+    }
+
+    if (!options_.schema.empty()) {
+      schemaPath_ = absolute(options_.schema);
+      if (!load_schema(schemaPath_, schema_)) return false;
+      // Editors often replace files by renaming, so watch the directory
+      add_watch(boost::filesystem::path(schemaPath_).parent_path().string());
+    }
+
+    std::vector<std::string> files;
+    for (const std::string& dir : options_.paths) {
+      if (!boost::filesystem::is_directory(dir)) {
+        std::cerr << "error: \"" << dir << "\" is not a directory" << std::endl;
+        return false;
+      }
+      if (!watch_tree(absolute(dir), files)) return false;
+    }
+    recheck(files, false);
+    started_ = true;
+    return true;
+  }
+
+  /// Wait for and process changes until an error occurs
+  int run() {
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    for (;;) {
+      std::set<std::string> changed;
+      std::set<std::string> removed;
+      bool schemaChanged(false);
+      bool overflow(false);
+
+      // Block for the first event, then gather whatever follows in a
+      // short window, as saving a file often produces several events
+      int timeout(-1);
+      pollfd pfd{fd_, POLLIN, 0};
+      while (poll(&pfd, 1, timeout) > 0) {
+        const ssize_t n = read(fd_, buffer, sizeof(buffer));
+        if (n <= 0) {
+          if (n < 0 && errno == EINTR) continue;
+          std::cerr << "error: reading inotify events: " << std::strerror(errno) << std::endl;
+          return 2;
+        }
+        for (const char* p = buffer; p < buffer + n;) {
+          const inotify_event* e = reinterpret_cast<const inotify_event*>(p);
+          if (e->mask & IN_Q_OVERFLOW) {
+            overflow = true;
+          } else {
+            handle(*e, changed, removed, schemaChanged);
+          }
+          p += sizeof(inotify_event) + e->len;
+        }
+        timeout = cCoalesceMs;
+      }
+
+      const Clock::time_point start = Clock::now();
+      if (overflow) {
+        // Events were lost, so anything may have changed: walk the trees
+        // again, and let unchanged files keep their results by hash
+        std::cout << "events lost, rescanning all directories\n";
+        changed.clear();
+        removed.clear();
+        std::vector<std::string> found;
+        for (const std::string& dir : options_.paths) watch_tree(absolute(dir), found);
+        changed.insert(found.begin(), found.end());
+        for (const auto& r : results_) {
+          if (!changed.count(r.first)) removed.insert(r.first);
+        }
+        schemaChanged = !schemaPath_.empty();
+      }
+
+      for (const std::string& f : removed) {
+        if (results_.erase(f)) std::cout << "GONE " << f << "\n";
+      }
+
+      std::vector<std::string> files;
+      if (schemaChanged) {
+        if (!load_schema(schemaPath_, schema_)) continue;
+        if (!overflow) std::cout << "schema changed, rechecking all files\n";
+        for (const auto& r : results_) changed.insert(r.first);
+      }
+      for (const std::string& f : changed) {
+        if (!removed.count(f)) files.push_back(f);
+      }
+      recheck(files, schemaChanged);
+      summarize(start);
+    }
+  }
+
+ private:
+  static const int cCoalesceMs = 20;
+
+  static std::string absolute(const std::string& path) {
+    return boost::filesystem::absolute(path).lexically_normal().string();
+  }
+
+  void add_watch(const std::string& dir) {
+    const int wd = inotify_add_watch(fd_, dir.c_str(),
+                                     IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                                     IN_CREATE | IN_DELETE);
+    if (wd >= 0) {
+      dirs_[wd] = dir;
+    } else {
+      std::cerr << "warning: cannot watch \"" << dir << "\": " << std::strerror(errno)
+                << std::endl;
+    }
+  }
+
+  /// Watch dir and its subdirectories, appending the files in them
+  bool watch_tree(const std::string& dir, std::vector<std::string>& files) {
+    namespace fs = boost::filesystem;
+    add_watch(dir);
+    boost::system::error_code ec;
+    fs::recursive_directory_iterator iter(dir, ec), end;
+    for (; !ec && iter != end; iter.increment(ec)) {
+      if (fs::is_directory(iter->status())) add_watch(iter->path().string());
+    }
+    return walk_directory(options_, dir, files);
+  }
+
+  void handle(const inotify_event& e,
+              std::set<std::string>& changed,
+              std::set<std::string>& removed,
+              bool& schemaChanged) {
+    auto dir = dirs_.find(e.wd);
+    if (e.mask & IN_IGNORED) {
+      if (dir != dirs_.end()) dirs_.erase(dir);
+      return;
+    }
+    if (dir == dirs_.end() || !e.len) return;
+    const std::string path = dir->second + "/" + e.name;
+
+    if (path == schemaPath_) {
+      schemaChanged = schemaChanged || (e.mask & (IN_CLOSE_WRITE | IN_MOVED_TO));
+      return;
+    }
+
+    if (e.mask & IN_ISDIR) {
+      if (e.mask & (IN_CREATE | IN_MOVED_TO)) {
+        std::vector<std::string> files;
+        watch_tree(path, files);
+        changed.insert(files.begin(), files.end());
+      } else if (e.mask & (IN_DELETE | IN_MOVED_FROM)) {
+        const std::string prefix = path + "/";
+        for (auto r = results_.lower_bound(prefix);
+             r != results_.end() && r->first.compare(0, prefix.size(), prefix) == 0; ++r) {
+          removed.insert(r->first);
+        }
+      }
+      return;
+    }
+
+    if (!wanted_file(options_, path)) return;
+    if (e.mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+      changed.insert(path);
+      removed.erase(path);
+    } else if (e.mask & (IN_DELETE | IN_MOVED_FROM)) {
+      removed.insert(path);
+      changed.erase(path);
+    }
+  }
+
+  /// Check files, reporting failures, and after the initial check, new
+  /// files and files whose content changed.
+  /// Files saved without changing their content keep their last result
+  /// without being parsed, and are only reported if force is set (e.g.
+  /// because the schema changed), when every file is parsed again.
+  void recheck(const std::vector<std::string>& files, bool force) {
+    const warwick::Schema* schema = schemaPath_.empty() ? nullptr : &schema_;
+    std::vector<FileResult> results;
+    check_files(files, schema, options_.jobs, results, force ? nullptr : &results_);
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      auto previous = results_.find(files[i]);
+      const bool known = previous != results_.end();
+      const bool same = known && previous->second.hash == results[i].hash;
+      if (!results[i].ok || (started_ && (force || !same))) print_result(files[i], results[i]);
+      results_[files[i]] = std::move(results[i]);
+    }
+  }
+
+  void summarize(Clock::time_point start) {
+    std::size_t failed(0);
+    for (const auto& r : results_) failed += r.second.ok ? 0 : 1;
+    std::cout << "[" << results_.size() << " files, " << failed << " failed, "
+              << elapsed_ms(start) << " ms]" << std::endl;
+  }
+
+ private:
+  const BatchOptions& options_;
+  int fd_ = -1;
+  std::map<int, std::string> dirs_;
+  std::string schemaPath_;
+  warwick::Schema schema_;
+  std::map<std::string, FileResult> results_;
+  bool started_ = false;
+};
+} // namespace
+
+int watch_main(const BatchOptions& options) {
+  Watcher watcher(options);
+  const Clock::time_point start = Clock::now();
+  if (!watcher.start()) return 2;
+  std::cout << "watching, initial check took " << elapsed_ms(start) << " ms" << std::endl;
+  return watcher.run();
+}
+#else
+int watch_main(const BatchOptions& /*options*/) {
+  std::cerr << "error: watch mode requires inotify (Linux)" << std::endl;
+  return 2;
+}
+#endif
+
+int daemon_main(const std::string& path, std::size_t cacheEntries) {
+  warwick::PropertyDaemon daemon(cacheEntries);
+  std::string error;
+  if (!daemon.listen(path, error)) {
+    std::cerr << "error: cannot listen on \"" << path << "\": " << error << std::endl;
+    return 2;
+  }
+  std::cout << "listening on " << path << std::endl;
+  daemon.serve();
+  return 0;
+}
+
+int emit_cpp_main(const EmitOptions& options) {
+  std::ifstream input(options.input);
+  if (!input) {
+    std::cerr << "error: cannot open \"" << options.input << "\"" << std::endl;
+    return 2;
+  }
+  input.unsetf(std::ios::skipws);
+
+  warwick::PropertyList document;
+  warwick::ParseErrorList errors;
+  if (!parse_document(input, document, errors)) {
+    for (const auto& e : errors) {
+      std::cerr << options.input << ":" << e.line << ":" << e.column << ": " << e.message
+                << std::endl;
+    }
+    return 1;
+  }
+
+  warwick::CppOptions cpp;
+  cpp.name = options.name;
+  cpp.nameSpace = options.nameSpace;
+  cpp.source = boost::filesystem::path(options.input).filename().string();
+  std::string header;
+  std::string error;
+  if (!warwick::emit_cpp(document, cpp, header, error)) {
+    std::cerr << "error: " << options.input << ": " << error << std::endl;
+    return 1;
+  }
+
+  if (options.output.empty()) {
+    std::cout << header;
+    return 0;
+  }
+
+  // Leave an unchanged header alone, so that its dependents are not rebuilt
+  std::ifstream existing(options.output, std::ios::binary);
+  if (existing) {
+    std::ostringstream current;
+    current << existing.rdbuf();
+    if (current.str() == header) return 0;
+  }
+  std::ofstream out(options.output, std::ios::binary | std::ios::trunc);
+  if (!(out << header) || !out.flush()) {
+    std::cerr << "error: cannot write \"" << options.output << "\"" << std::endl;
+    return 2;
+  }
+  return 0;
+}
@@ -9,11 +9,47 @@
 #ifndef PROPERTYCHECKERINTERFACES_HH
 #define PROPERTYCHECKERINTERFACES_HH
 
+// Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
 // - read and validate Property format text file
 int filereader_main(const char* filename);
 
 // - run command line interface for Property interpreter
 int cli_main();
 
+// - options for batch validation
+struct BatchOptions {
+  std::vector<std::string> paths;       // files, or directories to walk
+  std::vector<std::string> extensions;  // if set, only walk files with these
+  std::string schema;                   // optional schema file
+  std::size_t jobs = 0;                 // worker threads, 0 for all cores
+};
+
+// - validate many files in parallel, printing per-file status and a
+//   summary. Returns 0 if all files are valid, 1 if any failed, and 2
+//   if the batch could not be run
+int batch_main(const BatchOptions& options);
+
+// - check the directories in options.paths, then watch them (and the
+//   schema) with inotify, rechecking only files that change, or every
+//   file if the schema changes. Runs until interrupted. Linux only.
+int watch_main(const BatchOptions& options);
+
+// - serve parse/validate/query requests on a Unix socket at path,
+//   caching up to cacheEntries parsed documents. See PropertyDaemon.hpp
+int daemon_main(const std::string& path, std::size_t cacheEntries);
+
+struct EmitOptions {
+  std::string input;             // document to compile
+  std::string output;            // header to write, or empty for stdout
+  std::string name = "config";   // name of the constexpr instance
+  std::string nameSpace;         // optional namespace for the generated code
+};
+
+int emit_cpp_main(const EmitOptions& options);
+
 #endif // PROPERTYCHECKERINTERFACES_HH
 
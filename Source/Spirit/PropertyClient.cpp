@@ -0,0 +1,144 @@
+// - PropertyClient.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyClient.hpp"
+
+// Standard Library
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+// POSIX
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace warwick {
+namespace {
+std::string absolute(const std::string& file) {
+  if (!file.empty() && file[0] == '/') return file;
+  char cwd[4096];
+  if (!::getcwd(cwd, sizeof(cwd))) return file;
+  return std::string(cwd) + "/" + file;
+}
+} // namespace
+
+PropertyClient::PropertyClient() : fd_(-1) {}
+
+PropertyClient::~PropertyClient() {
+  close();
+}
+
+bool PropertyClient::connect(const std::string& path) {
+  close();
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) return false;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) return false;
+  if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void PropertyClient::close() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  buffer_.clear();
+}
+
+bool PropertyClient::request(const std::string& line, Response& response) {
+  if (fd_ < 0) return false;
+  const std::string data = line + "\n";
+  for (std::size_t sent = 0; sent < data.size();) {
+    const ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      close();
+      return false;
+    }
+    sent += static_cast<std::size_t>(n);
+  }
+
+  std::string status;
+  if (!read_line(status)) return false;
+  const std::string::size_type space = status.find(' ');
+  if (space == std::string::npos) {
+    close();
+    return false;
+  }
+  response.ok = status.compare(0, space, "OK") == 0;
+  const unsigned long count = std::strtoul(status.c_str() + space + 1, nullptr, 10);
+  response.lines.clear();
+  for (unsigned long i = 0; i < count; ++i) {
+    response.lines.emplace_back();
+    if (!read_line(response.lines.back())) return false;
+  }
+  return true;
+}
+
+bool PropertyClient::parse(const std::string& file, Response& response) {
+  return request("PARSE " + absolute(file), response);
+}
+
+bool PropertyClient::validate(const std::string& schema,
+                              const std::string& file,
+                              Response& response) {
+  return request("VALIDATE " + absolute(schema) + " " + absolute(file), response);
+}
+
+bool PropertyClient::query(const std::string& file,
+                           const std::string& key,
+                           Response& response) {
+  return request("QUERY " + key + " " + absolute(file), response);
+}
+
+ParseErrorList PropertyClient::errors(const Response& response) {
+  ParseErrorList result;
+  for (const std::string& l : response.lines) {
+    ParseError e{0, 0, l};
+    char* end(nullptr);
+    const unsigned long line = std::strtoul(l.c_str(), &end, 10);
+    if (end != l.c_str() && *end == ':') {
+      const char* columnStart = end + 1;
+      const unsigned long column = std::strtoul(columnStart, &end, 10);
+      if (end != columnStart && std::strncmp(end, ": ", 2) == 0) {
+        e = ParseError{line, column, std::string(end + 2)};
+      }
+    }
+    result.push_back(e);
+  }
+  return result;
+}
+
+bool PropertyClient::read_line(std::string& line) {
+  for (;;) {
+    const std::string::size_type end = buffer_.find('\n');
+    if (end != std::string::npos) {
+      line.assign(buffer_, 0, end);
+      buffer_.erase(0, end + 1);
+      return true;
+    }
+    char chunk[4096];
+    const ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      close();
+      return false;
+    }
+    buffer_.append(chunk, static_cast<std::size_t>(n));
+  }
+}
+} // namespace warwick
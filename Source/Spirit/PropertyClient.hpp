@@ -0,0 +1,71 @@
+// PropertyClient - client for the PropertyDaemon socket protocol
+//
+// Sends requests to a running daemon (see PropertyDaemon.hpp for the
+// protocol) over a single connection, which may be reused for any
+// number of requests. Relative file paths are made absolute before
+// sending, as the daemon may have a different working directory.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYCLIENT_HH
+#define PROPERTYCLIENT_HH
+
+// Standard Library
+#include <string>
+#include <vector>
+
+// This Project
+#include "PropertyParser.hpp"
+
+namespace warwick {
+class PropertyClient {
+ public:
+  /// Status and payload lines of a response
+  struct Response {
+    bool ok;
+    std::vector<std::string> lines;
+  };
+
+ public:
+  PropertyClient();
+  ~PropertyClient();
+
+  PropertyClient(const PropertyClient&) = delete;
+  PropertyClient& operator=(const PropertyClient&) = delete;
+
+  /// Connect to the daemon listening at path, returning true on success
+  bool connect(const std::string& path);
+
+  void close();
+
+  bool connected() const {
+    return fd_ >= 0;
+  }
+
+  /// Send a raw request line and read the response. Returns false if
+  /// the connection failed, in which case it is closed.
+  bool request(const std::string& line, Response& response);
+
+  bool parse(const std::string& file, Response& response);
+  bool validate(const std::string& schema, const std::string& file, Response& response);
+  bool query(const std::string& file, const std::string& key, Response& response);
+
+  /// Convert the payload of a failed PARSE/VALIDATE to errors. Lines that
+  /// are not positioned errors (e.g. unreadable files) get line 0.
+  static ParseErrorList errors(const Response& response);
+
+ private:
+  bool read_line(std::string& line);
+
+ private:
+  int fd_;
+  std::string buffer_;
+};
+} // namespace warwick
+
+#endif // PROPERTYCLIENT_HH
@@ -0,0 +1,310 @@
+// - PropertyCpp.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyCpp.hpp"
+
+// Standard Library
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <set>
+
+// This Project
+#include "OutputBuffer.hpp"
+
+namespace warwick {
+namespace {
+const char* const cKeywords[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+    "case", "catch", "char", "char16_t", "char32_t", "class", "compl", "const", "const_cast",
+    "constexpr", "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+    "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+    "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+    "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+    "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert",
+    "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true",
+    "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void",
+    "volatile", "wchar_t", "while", "xor", "xor_eq"};
+
+bool valid_identifier(const std::string& s) {
+  if (s.empty() || !(std::isalpha(static_cast<unsigned char>(s[0])) || s[0] == '_')) {
+    return false;
+  }
+  return std::all_of(s.begin(), s.end(), [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  });
+}
+
+/// C++ name for a property key
+std::string member_name(const std::string& key) {
+  for (const char* k : cKeywords) {
+    if (key == k) return key + "_";
+  }
+  return key;
+}
+
+std::string type_name(const std::string& key) {
+  return key + "_type";
+}
+
+/// Properties of list with only the last of equal keys, in document order
+std::vector<const Property*> unique_properties(const PropertyList& list) {
+  std::vector<const Property*> result;
+  std::set<std::string> seen;
+  for (auto p = list.rbegin(); p != list.rend(); ++p) {
+    if (seen.insert(p->Key).second) result.push_back(&*p);
+  }
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+/// Writes the declaration of a value's member type
+class TypeWriter : public boost::static_visitor<std::string> {
+ public:
+  explicit TypeWriter(const std::string& key) : key_(key) {}
+
+  std::string operator()(int) const {
+    return "int";
+  }
+
+  std::string operator()(double) const {
+    return "double";
+  }
+
+  std::string operator()(bool) const {
+    return "bool";
+  }
+
+  std::string operator()(const std::string&) const {
+    return "const char*";
+  }
+
+  std::string operator()(const boost::dynamic_bitset<>&) const {
+    return "unsigned long long";
+  }
+
+  template <typename T>
+  std::string operator()(const std::vector<T>& value) const {
+    return "std::array<" + (*this)(T()) + ", " + std::to_string(value.size()) + ">";
+  }
+
+  std::string operator()(const PropertyList&) const {
+    return type_name(key_);
+  }
+
+ private:
+  std::string key_;
+};
+
+/// Writes a value's initializer
+class ValueWriter : public boost::static_visitor<bool> {
+ public:
+  ValueWriter(OutputBuffer& out, std::string& error) : out_(out), error_(error) {}
+
+  bool operator()(int value) const {
+    // INT_MIN has no literal of type int
+    if (value == INT_MIN) {
+      out_.append("(-2147483647 - 1)");
+    } else {
+      out_.append_int(value);
+    }
+    return true;
+  }
+
+  bool operator()(double value) const {
+    if (std::isnan(value)) {
+      out_.append("std::numeric_limits<double>::quiet_NaN()");
+    } else if (std::isinf(value)) {
+      out_.append(value < 0 ? "-std::numeric_limits<double>::infinity()"
+                            : "std::numeric_limits<double>::infinity()");
+    } else {
+      out_.append_real(value, true);
+    }
+    return true;
+  }
+
+  bool operator()(bool value) const {
+    value ? out_.append("true", 4) : out_.append("false", 5);
+    return true;
+  }
+
+  bool operator()(const std::string& value) const {
+    out_.append('"');
+    for (char c : value) {
+      const unsigned char u = static_cast<unsigned char>(c);
+      if (c == '"' || c == '\\') {
+        out_.append('\\');
+        out_.append(c);
+      } else if (c == '\n') {
+        out_.append("\\n", 2);
+      } else if (c == '\t') {
+        out_.append("\\t", 2);
+      } else if (u < 0x20 || u == 0x7f) {
+        char escaped[5];
+        std::snprintf(escaped, sizeof(escaped), "\\%03o", u);
+        out_.append(escaped, 4);
+      } else {
+        out_.append(c);
+      }
+    }
+    out_.append('"');
+    return true;
+  }
+
+  bool operator()(const boost::dynamic_bitset<>& value) const {
+    if (value.empty() || value.size() > 64) {
+      error_ = "bitsets must have between 1 and 64 bits";
+      return false;
+    }
+    out_.append("0b", 2);
+    for (std::size_t i = value.size(); i > 0; --i) out_.append(value[i - 1] ? '1' : '0');
+    out_.append("ULL", 3);
+    return true;
+  }
+
+  template <typename T>
+  bool operator()(const std::vector<T>& value) const {
+    out_.append("{{", 2);
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (i) out_.append(", ", 2);
+      if (!(*this)(value[i])) return false;
+    }
+    out_.append("}}", 2);
+    return true;
+  }
+
+  bool operator()(const PropertyList& value) const {
+    out_.append('{');
+    bool first(true);
+    for (const Property* p : unique_properties(value)) {
+      if (!first) out_.append(", ", 2);
+      first = false;
+      if (!boost::apply_visitor(*this, p->Value)) return false;
+    }
+    out_.append('}');
+    return true;
+  }
+
+ private:
+  OutputBuffer& out_;
+  std::string& error_;
+};
+
+/// Write the struct for list, named name, indented depth levels
+bool write_struct(const PropertyList& list,
+                  const std::string& name,
+                  std::size_t depth,
+                  OutputBuffer& out,
+                  std::string& error) {
+  const std::vector<const Property*> properties = unique_properties(list);
+  std::set<std::string> names;
+  for (const Property* p : properties) {
+    if (!valid_identifier(p->Key)) {
+      error = "key '" + p->Key + "' is not a valid C++ identifier";
+      return false;
+    }
+    // Keys that are C++ keywords gain an underscore, which may give the
+    // name of another key
+    if (!names.insert(member_name(p->Key)).second) {
+      error = "key '" + p->Key + "' clashes with another key as member '" +
+              member_name(p->Key) + "'";
+      return false;
+    }
+  }
+  // A member may not have the name of the struct it is declared in
+  if (names.count(name)) {
+    error = "key '" + name + "' clashes with the type of its parent";
+    return false;
+  }
+
+  const std::string indent(2 * depth, ' ');
+  out.append(indent);
+  out.append("struct " + name + " {\n");
+  for (const Property* p : properties) {
+    const PropertyList* tree = boost::get<PropertyList>(&p->Value);
+    if (!tree) continue;
+    if (names.count(type_name(p->Key))) {
+      error = "key '" + type_name(p->Key) + "' clashes with the type of tree '" + p->Key + "'";
+      return false;
+    }
+    if (type_name(p->Key) == name) {
+      error = "type '" + name + "' of tree '" + p->Key + "' clashes with the type of its parent";
+      return false;
+    }
+    if (!write_struct(*tree, type_name(p->Key), depth + 1, out, error)) return false;
+  }
+  for (const Property* p : properties) {
+    out.append(indent);
+    out.append("  ");
+    out.append(boost::apply_visitor(TypeWriter(p->Key), p->Value));
+    out.append(' ');
+    out.append(member_name(p->Key));
+    out.append(";\n", 2);
+  }
+  out.append(indent);
+  out.append("};\n", 3);
+  return true;
+}
+
+std::string guard(const CppOptions& options) {
+  std::string result;
+  for (char c : options.nameSpace + "_" + options.name + "_HH") {
+    result += std::isalnum(static_cast<unsigned char>(c))
+                  ? static_cast<char>(std::toupper(static_cast<unsigned char>(c)))
+                  : '_';
+  }
+  return result.front() == '_' ? "PROPERTYCPP" + result : result;
+}
+} // namespace
+
+bool emit_cpp(const PropertyList& document,
+              const CppOptions& options,
+              std::string& buffer,
+              std::string& error) {
+  buffer.clear();
+  if (!valid_identifier(options.name) || member_name(options.name) != options.name) {
+    error = "'" + options.name + "' is not a valid C++ identifier";
+    return false;
+  }
+
+  OutputBuffer out(buffer);
+  out.append("// Generated by PropertyChecker --emit-cpp");
+  if (!options.source.empty()) out.append(" from " + options.source);
+  out.append(", do not edit\n\n", 15);
+  out.append("#ifndef " + guard(options) + "\n#define " + guard(options) + "\n\n");
+  out.append("#include <array>\n#include <limits>\n\n");
+  // Nested namespace definitions are C++17, so open each in turn
+  std::vector<std::string> namespaces;
+  for (std::string::size_type first = 0; first < options.nameSpace.size();) {
+    const std::string::size_type last = std::min(options.nameSpace.find("::", first),
+                                                 options.nameSpace.size());
+    namespaces.push_back(options.nameSpace.substr(first, last - first));
+    if (!valid_identifier(namespaces.back())) {
+      error = "'" + options.nameSpace + "' is not a valid C++ namespace";
+      return false;
+    }
+    first = last + 2;
+  }
+  for (const std::string& n : namespaces) out.append("namespace " + n + " {\n");
+
+  if (!write_struct(document, type_name(options.name), 0, out, error)) return false;
+  out.append("\nconstexpr " + type_name(options.name) + " " + options.name + " = ");
+  if (!ValueWriter(out, error)(document)) return false;
+  out.append(";\n", 2);
+
+  for (auto n = namespaces.rbegin(); n != namespaces.rend(); ++n) {
+    out.append("} // namespace " + *n + "\n");
+  }
+  out.append("\n#endif // " + guard(options) + "\n");
+  return true;
+}
+} // namespace warwick
@@ -0,0 +1,55 @@
+// PropertyCpp - compile documents into constexpr C++ headers
+//
+// Documents frozen at build time need not be looked up by string key at
+// runtime. emit_cpp() writes a header declaring a nested aggregate
+// struct that mirrors the document, and a constexpr instance holding its
+// values, so the compiler can constant-fold them:
+//
+//   geometry : {                  struct detector_type {
+//     width : real = [1.5, 2]       struct geometry_type {
+//     count : int = 4                 std::array<double, 2> width;
+//   }                                 int count;
+//                                   };
+//                                   geometry_type geometry;
+//                                 };
+//                                 constexpr detector_type detector = {...};
+//
+// Values map to int, double, bool, const char*, unsigned long long (for
+// bitsets of at most 64 bits) and std::array of the element type. If a
+// key occurs more than once, the last one wins. Keys that are C++
+// keywords get a trailing underscore.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYCPP_HH
+#define PROPERTYCPP_HH
+
+// Standard Library
+#include <string>
+
+// This Project
+#include "Property.hpp"
+
+namespace warwick {
+struct CppOptions {
+  std::string name;       // name of the instance, and of its type + "_type"
+  std::string nameSpace;  // optional enclosing namespace, may contain "::"
+  std::string source;     // optional name of the input, for the header comment
+};
+
+/// Write the header for document to buffer, replacing its contents.
+/// Returns false, describing the problem in error, if the document
+/// cannot be represented (bitsets longer than 64 bits, invalid names,
+/// or a key clashing with the type generated for a sibling tree).
+bool emit_cpp(const PropertyList& document,
+              const CppOptions& options,
+              std::string& buffer,
+              std::string& error);
+} // namespace warwick
+
+#endif // PROPERTYCPP_HH
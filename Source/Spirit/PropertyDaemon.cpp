@@ -0,0 +1,358 @@
+// - PropertyDaemon.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyDaemon.hpp"
+
+// Standard Library
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// POSIX
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// This Project
+#include "PerfectHash.hpp"
+#include "PropertyEmitter.hpp"
+#include "PropertyPath.hpp"
+
+namespace warwick {
+namespace {
+/// Longest request line accepted; longer ones are answered with an error
+/// and discarded, so no client can make a connection buffer grow further
+const std::size_t cMaxRequestSize = 64 * 1024;
+
+/// Read the whole of file in as few reads as possible, as it is read on
+/// every request
+bool read_file(const std::string& file, std::string& text) {
+  std::ifstream input(file, std::ios::binary);
+  if (!input) return false;
+  text.clear();
+  char chunk[64 * 1024];
+  while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0) {
+    text.append(chunk, static_cast<std::size_t>(input.gcount()));
+  }
+  return true;
+}
+
+/// Format a response from a status and payload lines
+std::string respond(bool ok, const std::vector<std::string>& lines) {
+  std::string r(ok ? "OK " : "ERR ");
+  r += std::to_string(lines.size());
+  r += '\n';
+  for (const std::string& l : lines) {
+    r += l;
+    r += '\n';
+  }
+  return r;
+}
+
+std::string respond_error(const std::string& message) {
+  return respond(false, std::vector<std::string>(1, message));
+}
+
+std::vector<std::string> format_errors(const ParseErrorList& errors) {
+  std::vector<std::string> lines;
+  for (const ParseError& e : errors) {
+    lines.push_back(std::to_string(e.line) + ":" + std::to_string(e.column) + ": " + e.message);
+  }
+  return lines;
+}
+
+bool send_all(int fd, const std::string& data) {
+  const char* p = data.data();
+  std::size_t left = data.size();
+  while (left) {
+    const ssize_t n = ::send(fd, p, left, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    left -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+} // namespace
+
+PropertyDaemon::PropertyDaemon(std::size_t maxEntries)
+    : maxEntries_(maxEntries ? maxEntries : 1),
+      listenFd_(-1),
+      socketDevice_(0),
+      socketInode_(0),
+      running_(false),
+      active_(0),
+      requests_(0),
+      hits_(0),
+      misses_(0) {}
+
+PropertyDaemon::~PropertyDaemon() {
+  stop();
+  // Connections hold this, so wait for them to notice the shutdown.
+  // The last one signals while holding the lock, so none touches this
+  // once the wait returns
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return active_ == 0; });
+}
+
+bool PropertyDaemon::listen(const std::string& path, std::string& error) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    error = "socket path too long";
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  // Only a socket left by an earlier daemon may be replaced
+  struct stat st;
+  if (::lstat(path.c_str(), &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      error = "\"" + path + "\" exists and is not a socket";
+      return false;
+    }
+    ::unlink(path.c_str());
+  } else if (errno != ENOENT) {
+    error = std::strerror(errno);
+    return false;
+  }
+
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    error = std::strerror(errno);
+    return false;
+  }
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+      ::listen(fd, SOMAXCONN) < 0 || ::lstat(path.c_str(), &st) < 0) {
+    error = std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+  listenFd_ = fd;
+  path_ = path;
+  socketDevice_ = st.st_dev;
+  socketInode_ = st.st_ino;
+  running_ = true;
+  return true;
+}
+
+void PropertyDaemon::serve() {
+  while (running_) {
+    const int listenFd = listenFd_;
+    if (listenFd < 0) break;
+    const int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!running_) {
+        ::close(fd);
+        break;
+      }
+      clients_.insert(fd);
+      ++active_;
+    }
+    std::thread(&PropertyDaemon::serve_connection, this, fd).detach();
+  }
+}
+
+void PropertyDaemon::stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!running_.exchange(false)) return;
+  // Shutting down wakes threads blocked in accept or read
+  const int listenFd = listenFd_.exchange(-1);
+  ::shutdown(listenFd, SHUT_RDWR);
+  ::close(listenFd);
+  struct stat st;
+  if (::lstat(path_.c_str(), &st) == 0 && st.st_dev == socketDevice_ &&
+      st.st_ino == socketInode_) {
+    ::unlink(path_.c_str());
+  }
+  for (int fd : clients_) ::shutdown(fd, SHUT_RDWR);
+}
+
+void PropertyDaemon::serve_connection(int fd) {
+  std::string pending;
+  std::string::size_type scanned(0);  // pending has no newline before this
+  bool discarding(false);             // in the tail of an overlong request
+  char buffer[4096];
+  for (;;) {
+    const ssize_t n = ::read(fd, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    pending.append(buffer, static_cast<std::size_t>(n));
+
+    std::string::size_type start(0), end(scanned);
+    bool ok(true);
+    while (ok && (end = pending.find('\n', end)) != std::string::npos) {
+      if (!discarding) ok = send_all(fd, handle(pending.substr(start, end - start)));
+      discarding = false;
+      start = ++end;
+    }
+    if (!ok) break;
+    pending.erase(0, start);
+    if (pending.size() > cMaxRequestSize) {
+      if (!discarding && !send_all(fd, respond_error("request too long"))) break;
+      discarding = true;
+      pending.clear();
+    }
+    scanned = pending.size();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  clients_.erase(fd);
+  ::close(fd);
+  if (--active_ == 0) idle_.notify_all();
+}
+
+std::string PropertyDaemon::handle(const std::string& request) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++requests_;
+  }
+
+  // Split off the command and, for two argument requests, the first
+  // argument. The file is always the remainder of the line.
+  std::string line(request);
+  if (!line.empty() && line.back() == '\r') line.pop_back();
+  const std::string::size_type space = line.find(' ');
+  const std::string command = line.substr(0, space);
+  std::string rest = space == std::string::npos ? std::string() : line.substr(space + 1);
+  std::string argument;
+  if (command == "VALIDATE" || command == "QUERY") {
+    const std::string::size_type next = rest.find(' ');
+    if (next == std::string::npos) return respond_error("usage: " + command + " <arg> <file>");
+    argument = rest.substr(0, next);
+    rest.erase(0, next + 1);
+  }
+
+  if (command == "STATS") {
+    const Statistics s = statistics();
+    std::ostringstream os;
+    os << "requests=" << s.requests << " hits=" << s.hits << " misses=" << s.misses
+       << " entries=" << s.entries;
+    return respond(true, std::vector<std::string>(1, os.str()));
+  }
+  if (command != "PARSE" && command != "VALIDATE" && command != "QUERY") {
+    return respond_error("unknown request \"" + command + "\"");
+  }
+  if (rest.empty()) return respond_error("no file given");
+
+  std::string error;
+  document_ptr doc = load(rest, command == "VALIDATE" ? argument : std::string(), error);
+  if (!doc) return respond_error(error);
+  if (!doc->ok) return respond(false, format_errors(doc->errors));
+  if (command != "QUERY") return respond(true, std::vector<std::string>());
+
+  const Property* p = find_property(doc->properties, argument);
+  if (!p) return respond_error("no property \"" + argument + "\"");
+  std::string value;
+  emit_value(*p, value);
+  std::vector<std::string> lines;
+  std::istringstream is(value);
+  for (std::string l; std::getline(is, l);) lines.push_back(l);
+  return respond(true, lines);
+}
+
+PropertyDaemon::Statistics PropertyDaemon::statistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Statistics{requests_, hits_, misses_, cache_.size()};
+}
+
+std::shared_ptr<const Schema> PropertyDaemon::load_schema(const std::string& file,
+                                                          std::uint64_t& key,
+                                                          std::string& error) {
+  std::string text;
+  if (!read_file(file, text)) {
+    error = "cannot open schema \"" + file + "\"";
+    return nullptr;
+  }
+  key = fnv1a(text.data(), text.size());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = schemas_.find(key);
+    if (found != schemas_.end() && found->second.source == text) return found->second.schema;
+  }
+
+  std::shared_ptr<Schema> schema = std::make_shared<Schema>();
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  std::string message;
+  if (!schema->read(input, message)) {
+    error = "invalid schema \"" + file + "\": " + message;
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Schemas change rarely, so just forget them all should many pile up
+  if (schemas_.size() >= 64) schemas_.clear();
+  schemas_[key] = SchemaEntry{text, schema};
+  return schema;
+}
+
+PropertyDaemon::document_ptr PropertyDaemon::load(const std::string& file,
+                                                  const std::string& schemaFile,
+                                                  std::string& error) {
+  CacheKey key{0, 0};
+  std::shared_ptr<const Schema> schema;
+  if (!schemaFile.empty()) {
+    schema = load_schema(schemaFile, key.schema, error);
+    if (!schema) return nullptr;
+  }
+
+  std::string text;
+  if (!read_file(file, text)) {
+    error = "cannot open \"" + file + "\"";
+    return nullptr;
+  }
+  key.content = fnv1a(text.data(), text.size());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = cache_.find(key);
+    if (found != cache_.end() && found->second->source == text &&
+        found->second->schema == schema) {
+      ++hits_;
+      return found->second;
+    }
+    ++misses_;
+  }
+
+  // Parse outside the lock, so requests for other documents proceed
+  std::shared_ptr<Document> doc = std::make_shared<Document>();
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  doc->ok = schema ? parse_document(input, doc->properties, *schema, doc->errors)
+                   : parse_document(input, doc->properties, doc->errors);
+  doc->source = std::move(text);
+  doc->schema = schema;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto inserted = cache_.emplace(key, doc);
+  if (inserted.second) {
+    order_.push_back(key);
+    // Evict the oldest entries. Requests still using them keep them alive
+    while (cache_.size() > maxEntries_) {
+      cache_.erase(order_.front());
+      order_.pop_front();
+    }
+  } else {
+    // A colliding or stale entry, which the latest document replaces
+    inserted.first->second = doc;
+  }
+  return doc;
+}
+} // namespace warwick
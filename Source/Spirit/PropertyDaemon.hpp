@@ -0,0 +1,146 @@
+// PropertyDaemon - serve parse/validate/query requests over a socket
+//
+// Tools that each parse the same shared files can instead ask a
+// long-running daemon, which keeps parsed documents in memory. Documents
+// are cached by their content (and that of the schema, when
+// validating), so the daemon still reads the file on every request but
+// only parses it when its content is new. Requests are single lines over
+// a Unix domain stream socket, and may be repeated on one connection:
+//
+//   PARSE <file>                 parse the file
+//   VALIDATE <schema> <file>     parse the file, checking it against schema
+//   QUERY <key.path> <file>      value of a property, in property syntax
+//   STATS                        cache statistics
+//
+// Arguments are separated by single spaces, so all but the last (which
+// is always a file) must not contain spaces. Files should be given as
+// absolute paths, as they are opened by the daemon. Each response is a
+// status line, "OK <n>" or "ERR <n>", followed by n lines of payload:
+// nothing for a successful PARSE/VALIDATE, "<line>:<column>: <message>"
+// for each error, or the value for QUERY (trees span several lines).
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYDAEMON_HH
+#define PROPERTYDAEMON_HH
+
+// Standard Library
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+// POSIX
+#include <sys/types.h>
+
+// This Project
+#include "Property.hpp"
+#include "PropertyParser.hpp"
+#include "Schema.hpp"
+
+namespace warwick {
+class PropertyDaemon {
+ public:
+  struct Statistics {
+    std::size_t requests;
+    std::size_t hits;
+    std::size_t misses;
+    std::size_t entries;
+  };
+
+ public:
+  /// Construct daemon caching at most maxEntries parse results
+  explicit PropertyDaemon(std::size_t maxEntries = 4096);
+  ~PropertyDaemon();
+
+  PropertyDaemon(const PropertyDaemon&) = delete;
+  PropertyDaemon& operator=(const PropertyDaemon&) = delete;
+
+  /// Listen on a Unix socket at path, replacing any stale socket file,
+  /// but never a file of another kind. Returns false and describes the
+  /// problem in error on failure
+  bool listen(const std::string& path, std::string& error);
+
+  /// Accept and serve connections, each on its own thread, until stop()
+  void serve();
+
+  /// Stop serving, closing the listening socket, and removing its file
+  /// unless something else has since replaced it
+  void stop();
+
+  /// Return the response to a single request line (without newline)
+  std::string handle(const std::string& request);
+
+  Statistics statistics() const;
+
+ private:
+  /// Result of parsing one document, shared with requests in flight.
+  /// Cache keys are only hashes, so it keeps the text and schema it came
+  /// from to tell a hit from a collision
+  struct Document {
+    bool ok;
+    ParseErrorList errors;
+    PropertyList properties;
+    std::string source;
+    std::shared_ptr<const Schema> schema;
+  };
+  typedef std::shared_ptr<const Document> document_ptr;
+
+  struct CacheKey {
+    std::uint64_t content;
+    std::uint64_t schema;
+    bool operator==(const CacheKey& other) const {
+      return content == other.content && schema == other.schema;
+    }
+  };
+
+  struct CacheKeyHash {
+    std::size_t operator()(const CacheKey& k) const {
+      return static_cast<std::size_t>(k.content ^ (k.schema * 0x9E3779B97F4A7C15ULL));
+    }
+  };
+
+  /// A parsed schema and the text it was parsed from
+  struct SchemaEntry {
+    std::string source;
+    std::shared_ptr<const Schema> schema;
+  };
+
+  document_ptr load(const std::string& file, const std::string& schemaFile, std::string& error);
+  std::shared_ptr<const Schema> load_schema(const std::string& file, std::uint64_t& key,
+                                            std::string& error);
+  void serve_connection(int fd);
+
+ private:
+  const std::size_t maxEntries_;
+  std::atomic<int> listenFd_;
+  std::string path_;
+  dev_t socketDevice_;  // identify the socket file bound at path_
+  ino_t socketInode_;
+  std::atomic<bool> running_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable idle_;  // signalled when active_ drops to 0
+  std::size_t active_;            // connection threads, guarded by mutex_
+  std::unordered_map<CacheKey, document_ptr, CacheKeyHash> cache_;
+  std::deque<CacheKey> order_;
+  std::unordered_map<std::uint64_t, SchemaEntry> schemas_;
+  std::set<int> clients_;
+  std::size_t requests_;
+  std::size_t hits_;
+  std::size_t misses_;
+};
+} // namespace warwick
+
+#endif // PROPERTYDAEMON_HH
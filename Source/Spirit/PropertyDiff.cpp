@@ -0,0 +1,174 @@
+// - PropertyDiff.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyDiff.hpp"
+
+// Standard Library
+#include <algorithm>
+#include <cstdint>
+
+// Third Party
+// - Boost
+#include "boost/utility/string_ref.hpp"
+
+namespace warwick {
+namespace {
+//----------------------------------------------------------------------
+// Comparison
+struct Entry {
+  boost::string_ref key;
+  const Property* property;
+  std::size_t at;
+};
+
+/// Entries of list, whose first property is at index position first,
+/// sorted by key with only the last of equal keys kept
+std::vector<Entry> entries(const PropertyList& list, std::size_t first,
+                           const DocumentHash& index) {
+  std::vector<Entry> result;
+  result.reserve(list.size());
+  for (const Property& p : list) {
+    result.push_back(Entry{boost::string_ref(p.Key), &p, first});
+    first += index.subtree_size(first);
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](const Entry& a, const Entry& b) { return a.key < b.key; });
+  auto last = std::unique(result.rbegin(), result.rend(),
+                          [](const Entry& a, const Entry& b) { return a.key == b.key; });
+  result.erase(result.begin(), last.base());
+  return result;
+}
+
+class Differ {
+ public:
+  Differ(const DocumentHash& before, const DocumentHash& after, PropertyChangeList& changes)
+      : before_(before), after_(after), changes_(changes) {}
+
+  void compare(const PropertyList& before, std::size_t beforeFirst,
+               const PropertyList& after, std::size_t afterFirst,
+               const std::string& prefix) {
+    const std::vector<Entry> b = entries(before, beforeFirst, before_);
+    const std::vector<Entry> a = entries(after, afterFirst, after_);
+
+    auto i = b.begin();
+    auto j = a.begin();
+    while (i != b.end() || j != a.end()) {
+      if (j == a.end() || (i != b.end() && i->key < j->key)) {
+        report(PropertyChange::Removed, prefix, i->key);
+        ++i;
+      } else if (i == b.end() || j->key < i->key) {
+        report(PropertyChange::Added, prefix, j->key);
+        ++j;
+      } else {
+        // Equal hashes are confirmed by content, in case they collide
+        if (before_.hash(i->at) != after_.hash(j->at) ||
+            !same_property(*i->property, *j->property)) {
+          const PropertyList* bt = boost::get<PropertyList>(&i->property->Value);
+          const PropertyList* at = boost::get<PropertyList>(&j->property->Value);
+          if (bt && at) {
+            compare(*bt, i->at + 1, *at, j->at + 1, path(prefix, i->key));
+          } else {
+            report(PropertyChange::Changed, prefix, i->key);
+          }
+        }
+        ++i;
+        ++j;
+      }
+    }
+  }
+
+ private:
+  static std::string path(const std::string& prefix, boost::string_ref key) {
+    std::string result(prefix);
+    if (!result.empty()) result += '.';
+    result.append(key.data(), key.size());
+    return result;
+  }
+
+  void report(PropertyChange::Kind kind, const std::string& prefix, boost::string_ref key) {
+    changes_.push_back(PropertyChange{kind, path(prefix, key)});
+  }
+
+ private:
+  const DocumentHash& before_;
+  const DocumentHash& after_;
+  PropertyChangeList& changes_;
+};
+
+/// True if the change at path concerns the subtree at prefix
+bool concerns(const std::string& path, const std::string& prefix) {
+  const std::string& shorter = path.size() < prefix.size() ? path : prefix;
+  const std::string& longer = path.size() < prefix.size() ? prefix : path;
+  if (shorter.empty()) return true;
+  return longer.compare(0, shorter.size(), shorter) == 0 &&
+         (longer.size() == shorter.size() || longer[shorter.size()] == '.');
+}
+} // namespace
+
+PropertyChangeList diff_documents(const PropertyList& before, const PropertyList& after) {
+  return diff_documents(before, DocumentHash(before), after, DocumentHash(after));
+}
+
+PropertyChangeList diff_documents(const PropertyList& before,
+                                  const DocumentHash& beforeHash,
+                                  const PropertyList& after,
+                                  const DocumentHash& afterHash) {
+  PropertyChangeList changes;
+  if (beforeHash != afterHash || !same_document(before, after)) {
+    Differ(beforeHash, afterHash, changes).compare(before, 0, after, 0, std::string());
+  }
+  return changes;
+}
+
+ChangeNotifier::Subscription ChangeNotifier::subscribe(const std::string& prefix,
+                                                       Callback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  subscribers_.push_back(Subscriber{next_, prefix, std::move(callback)});
+  return next_++;
+}
+
+void ChangeNotifier::unsubscribe(Subscription id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                    [id](const Subscriber& s) { return s.id == id; }),
+                     subscribers_.end());
+}
+
+void ChangeNotifier::notify(const PropertyChangeList& changes) const {
+  if (changes.empty()) return;
+
+  // Callbacks run unlocked, so they may (un)subscribe
+  std::vector<Subscriber> subscribers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers = subscribers_;
+  }
+
+  PropertyChangeList matched;
+  for (const Subscriber& s : subscribers) {
+    matched.clear();
+    for (const PropertyChange& c : changes) {
+      if (concerns(c.path, s.prefix)) matched.push_back(c);
+    }
+    if (!matched.empty()) s.callback(matched);
+  }
+}
+
+void ChangeNotifier::update(const PropertyList& before, const PropertyList& after) const {
+  notify(diff_documents(before, after));
+}
+
+void ChangeNotifier::update(const PropertyList& before,
+                            const DocumentHash& beforeHash,
+                            const PropertyList& after,
+                            const DocumentHash& afterHash) const {
+  notify(diff_documents(before, beforeHash, after, afterHash));
+}
+} // namespace warwick
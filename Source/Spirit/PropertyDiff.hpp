@@ -0,0 +1,103 @@
+// PropertyDiff - structural differences between documents
+//
+// diff_documents compares two versions of a document by key and reports
+// the dotted paths (as used by find_property) that were added, removed
+// or changed. Trees present in both versions are compared property by
+// property; anything else whose value or type differs is reported as
+// changed. A subtree that was added or removed is reported once, by its
+// own path. As for lookup, the last of several equal keys wins.
+//
+// Subtrees whose hashes (see PropertyHash.hpp) differ are descended into
+// at once, and only those whose hashes match are compared in full, to
+// confirm that they are really unchanged. Given the documents' hashes,
+// finding what changed costs in proportion to the changes.
+//
+// ChangeNotifier delivers the changes to subscribers registered on path
+// prefixes, so that after a reload components only reconfigure when
+// something under their own subtree changed.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYDIFF_HH
+#define PROPERTYDIFF_HH
+
+// Standard Library
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// This Project
+#include "Property.hpp"
+#include "PropertyHash.hpp"
+
+namespace warwick {
+struct PropertyChange {
+  enum Kind { Added, Removed, Changed };
+
+  Kind kind;
+  std::string path;
+};
+
+typedef std::vector<PropertyChange> PropertyChangeList;
+
+/// Return the changes from before to after, sorted by key at each level
+PropertyChangeList diff_documents(const PropertyList& before, const PropertyList& after);
+
+/// As above, reusing hashes already computed for the documents
+PropertyChangeList diff_documents(const PropertyList& before,
+                                  const DocumentHash& beforeHash,
+                                  const PropertyList& after,
+                                  const DocumentHash& afterHash);
+
+/// Dispatches document changes to subscribers by path prefix
+class ChangeNotifier {
+ public:
+  typedef std::function<void(const PropertyChangeList&)> Callback;
+  typedef std::size_t Subscription;
+
+ public:
+  ChangeNotifier() : next_(0) {}
+
+  ChangeNotifier(const ChangeNotifier&) = delete;
+  ChangeNotifier& operator=(const ChangeNotifier&) = delete;
+
+  /// Call callback with the changes at or below prefix (or above it,
+  /// when a whole enclosing tree is replaced). An empty prefix matches
+  /// every change.
+  Subscription subscribe(const std::string& prefix, Callback callback);
+
+  void unsubscribe(Subscription id);
+
+  /// Deliver changes to each subscriber with at least one match.
+  /// Callbacks run on the calling thread.
+  void notify(const PropertyChangeList& changes) const;
+
+  /// Diff two documents and notify subscribers of the changes
+  void update(const PropertyList& before, const PropertyList& after) const;
+
+  void update(const PropertyList& before,
+              const DocumentHash& beforeHash,
+              const PropertyList& after,
+              const DocumentHash& afterHash) const;
+
+ private:
+  struct Subscriber {
+    Subscription id;
+    std::string prefix;
+    Callback callback;
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Subscriber> subscribers_;
+  Subscription next_;
+};
+} // namespace warwick
+
+#endif // PROPERTYDIFF_HH
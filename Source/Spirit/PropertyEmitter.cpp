@@ -0,0 +1,161 @@
+// - PropertyEmitter.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyEmitter.hpp"
+
+// Standard Library
+#include <cctype>
+
+// This Project
+#include "OutputBuffer.hpp"
+
+namespace warwick {
+namespace {
+/// Keys must be identifiers: [a-zA-Z][a-zA-Z0-9_]*
+bool valid_key(const std::string& key) {
+  if (key.empty() || !std::isalpha(static_cast<unsigned char>(key[0]))) return false;
+  for (char c : key) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+  }
+  return true;
+}
+
+/// Quoted strings are non-empty and cannot hold '"'
+bool valid_string(const std::string& s) {
+  return !s.empty() && s.find('"') == std::string::npos;
+}
+
+class Emitter : public boost::static_visitor<bool> {
+ public:
+  Emitter(OutputBuffer& out, std::size_t depth) : out_(out), depth_(depth) {}
+
+  bool document(const PropertyList& list) {
+    for (const Property& p : list) {
+      if (!valid_key(p.Key)) return false;
+      out_.append(2 * depth_, ' ');
+      out_.append(p.Key);
+      out_.append(" : ", 3);
+      if (!boost::apply_visitor(*this, p.Value)) return false;
+      out_.append('\n');
+      out_.maybe_flush();
+    }
+    return true;
+  }
+
+  bool operator()(int value) const {
+    out_.append("int = ", 6);
+    out_.append_int(value);
+    return true;
+  }
+
+  bool operator()(double value) const {
+    out_.append("real = ", 7);
+    out_.append_real(value);
+    return true;
+  }
+
+  bool operator()(bool value) const {
+    value ? out_.append("bool = true", 11) : out_.append("bool = false", 12);
+    return true;
+  }
+
+  bool operator()(const std::string& value) const {
+    if (!valid_string(value)) return false;
+    out_.append("string = ", 9);
+    quoted(value);
+    return true;
+  }
+
+  bool operator()(const boost::dynamic_bitset<>& value) const {
+    if (value.empty() || value.size() > 64) return false;
+    out_.append("bitset = ", 9);
+    // Most significant bit first, as read by the grammar
+    for (std::size_t i = value.size(); i > 0; --i) {
+      out_.append(value[i - 1] ? '1' : '0');
+    }
+    return true;
+  }
+
+  bool operator()(const std::vector<int>& value) const {
+    if (value.empty()) return false;
+    out_.append("int = [", 7);
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (i) out_.append(", ", 2);
+      out_.append_int(value[i]);
+      out_.maybe_flush();
+    }
+    out_.append(']');
+    return true;
+  }
+
+  bool operator()(const std::vector<double>& value) const {
+    if (value.empty()) return false;
+    out_.append("real = [", 8);
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (i) out_.append(", ", 2);
+      out_.append_real(value[i]);
+      out_.maybe_flush();
+    }
+    out_.append(']');
+    return true;
+  }
+
+  bool operator()(const std::vector<std::string>& value) const {
+    if (value.empty()) return false;
+    out_.append("string = [", 10);
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (!valid_string(value[i])) return false;
+      if (i) out_.append(", ", 2);
+      quoted(value[i]);
+      out_.maybe_flush();
+    }
+    out_.append(']');
+    return true;
+  }
+
+  bool operator()(const PropertyList& value) const {
+    if (value.empty()) return false;
+    out_.append("{\n", 2);
+    Emitter inner(out_, depth_ + 1);
+    if (!inner.document(value)) return false;
+    out_.append(2 * depth_, ' ');
+    out_.append('}');
+    return true;
+  }
+
+ private:
+  void quoted(const std::string& s) const {
+    out_.append('"');
+    out_.append(s);
+    out_.append('"');
+  }
+
+ private:
+  OutputBuffer& out_;
+  std::size_t depth_;
+};
+} // namespace
+
+bool emit_document(const PropertyList& document, std::string& buffer) {
+  OutputBuffer out(buffer);
+  return Emitter(out, 0).document(document);
+}
+
+bool emit_document(const PropertyList& document, std::ostream& os) {
+  OutputBuffer out(os);
+  return Emitter(out, 0).document(document);
+}
+
+bool emit_value(const Property& p, std::string& buffer) {
+  OutputBuffer out(buffer);
+  Emitter emitter(out, 0);
+  return boost::apply_visitor(emitter, p.Value);
+}
+} // namespace warwick
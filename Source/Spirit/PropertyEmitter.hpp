@@ -0,0 +1,50 @@
+// PropertyEmitter - write PropertyLists back out in property syntax
+//
+// The ostream operators in Property.hpp print a debugging format that
+// cannot be read back in. The emitter writes canonical property syntax,
+//
+//   key : int = 1
+//   reals : real = [1.5, 2]
+//   tree : {
+//     flag : bool = true
+//   }
+//
+// which parse_document reads back to an identical PropertyList. Reals are
+// written with the fewest digits that convert back exactly.
+//
+// Some values have no representation in the syntax: empty strings,
+// arrays and trees, strings containing '"', bitsets that are empty or
+// longer than 64 bits, and keys that are not identifiers. Emitting these
+// fails, leaving the output written so far in place.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYEMITTER_HH
+#define PROPERTYEMITTER_HH
+
+// Standard Library
+#include <iosfwd>
+#include <string>
+
+// This Project
+#include "Property.hpp"
+
+namespace warwick {
+/// Append canonical property syntax for document to buffer, returning
+/// true if every value could be represented
+bool emit_document(const PropertyList& document, std::string& buffer);
+
+/// Write canonical property syntax for document to os
+bool emit_document(const PropertyList& document, std::ostream& os);
+
+/// Append canonical syntax for the value of p, i.e. the text following
+/// "<key> : ", e.g. "int = 1", or "{ ... }" for trees
+bool emit_value(const Property& p, std::string& buffer);
+} // namespace warwick
+
+#endif // PROPERTYEMITTER_HH
@@ -50,10 +50,20 @@
 // ------------
 // Entries can have descriptions:
 //
-//  #@description "foo bars"
+//  @description "foo bars"
 //  foo : int = 1
 //
-// Not implemented yet.
+// These are not stored in the Property itself, but may be collected
+// into a PropertyDescriptions side table keyed by the dotted path
+// of the property, e.g. "bar.foo". If no table is supplied to the grammar,
+// descriptions are parsed and discarded without any extra overhead.
+//
+// Schemas
+// -------
+// A compiled Schema (see Schema.hpp) may be checked while the document
+// is parsed, rather than in a second pass over the PropertyList. The
+// SchemaValidator looks up each property as its key is parsed, and
+// checks its value once the assignment completes.
 //
 // Array specification
 // -------------------
@@ -115,8 +125,19 @@
 // and any path operations are the job of the path object, not the parser).
 //
 // Similar syntax may be added, so this needs to be watched for.
-// In the dimension case, it may be easier simply to have the parser
-// look for units following the number.
+//
+// Reals with a dimension are now parsed as quantities, whose value is
+// a real followed by a unit expression (see UnitsGrammar.hpp), or an
+// array of these:
+//
+//  width : real as length = 3.14 mm
+//  gaps : real as length = [1 mm, 0.5 cm]
+//
+// The unit must have the declared dimension, which is one of the names
+// in Units/UnitDimension.hpp. Values are converted to SI units as they
+// are parsed and stored as plain reals, so the above reads as 0.00314,
+// and consumers never see unit strings. A unit may only be omitted for
+// a dimensionless quantity.
 //
 //
 //
@@ -127,20 +148,29 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#ifndef PROPERTYGRAMMAR_HH
+#define PROPERTYGRAMMAR_HH
+
 // Standard Library
 #include <iostream>
 #include <iterator>
 #include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
 // Third Party
 // - Boost
 #define BOOST_SPIRIT_DEBUG
 #include "boost/fusion/include/adapt_struct.hpp"
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/qi_char.hpp>
+#include <boost/spirit/repository/include/qi_iter_pos.hpp>
 
 // This Project
 #include "Property.hpp"
 #include "BitsetGrammar.hpp"
+#include "Schema.hpp"
+#include "UnitsGrammar.hpp"
 
 // NB: using a struct for convenience, later, can use ADAPT_ADT for getting/setting
 // attributes
@@ -158,34 +188,296 @@ namespace qi = boost::spirit::qi;
 namespace ascii = boost::spirit::ascii;
 namespace phx = boost::phoenix;
 
-template <typename Iterator, typename Skipper>
-class PropertyGrammar : public qi::grammar<Iterator, warwick::Property(), Skipper> {
+/// Collects descriptions into a PropertyDescriptions table as they are
+/// parsed, tracking the path of the current property through nested trees.
+/// The path is held as a single string plus the lengths at which each
+/// level starts, so descending/ascending does not allocate per level.
+class DescriptionRecorder {
  public:
-  PropertyGrammar() : PropertyGrammar::base_type(property) {
-    // The fundamental property.
-    // Note that we omit the description for now.
-    // TODO: Note that including description will result in slightly
-    // awkward parser attribute: tuple<Desc, tuple<Id, Value> >
-    // which is significant when adapting to the in-memory object
-    property %= qi::omit[-description] >> (identifier > ':' > assignment);
+  explicit DescriptionRecorder(PropertyDescriptions& table) : table_(table) {}
 
-    description %= "@description" > quotedstring;
+  /// Hold a description until the key it belongs to is parsed
+  void describe(const std::string& text) {
+    pending_ = text;
+    hasPending_ = true;
+  }
 
-    identifier %= qi::alpha >> *(qi::alnum | qi::char_('_'));
-    quotedstring %= qi::lexeme['"' >> +(qi::char_ - '"') >> '"'];
+  /// Register the key of the property being parsed
+  void key(const std::string& k) {
+    current_ = k;
+    if (hasPending_) {
+      table_[prefix_ + k] = pending_;
+      hasPending_ = false;
+    }
+  }
 
-    // assignment may be a terminal node or a subtree
-    assignment %= node | tree;
+  /// Descend into the subtree of the current key
+  void enter() {
+    marks_.push_back(prefix_.size());
+    prefix_ += current_;
+    prefix_ += '.';
+  }
+
+  /// Ascend from the current subtree
+  void leave() {
+    prefix_.resize(marks_.back());
+    marks_.pop_back();
+  }
+
+  /// Forget any partial state, e.g. after a failed parse
+  void reset() {
+    prefix_.clear();
+    marks_.clear();
+    hasPending_ = false;
+  }
+
+ private:
+  PropertyDescriptions& table_;
+  std::string prefix_;
+  std::vector<std::string::size_type> marks_;
+  std::string current_;
+  std::string pending_;
+  bool hasPending_ = false;
+};
+
+/// A parse failure at a position in the input
+template <typename Iterator>
+struct ParseFailure {
+  Iterator where;
+  std::string message;
+};
+
+/// Collects failures during a parse. Only the first (innermost)
+/// expectation failure is kept for each recovery, because the enclosing
+/// properties then fail in turn on the same error. Without recovery, the
+/// failure that stopped the parse is left pending.
+template <typename Iterator>
+class ErrorCollector {
+ public:
+  typedef std::vector<ParseFailure<Iterator> > failure_list;
 
+  /// Record an expectation failure, unless one is already pending
+  void expected(Iterator where, const qi::info& what) {
+    std::ostringstream os;
+    os << "expected " << what;
+    fail(where, os.str());
+  }
+
+  /// Record a failure, unless one is already pending
+  void fail(Iterator where, const std::string& message) {
+    if (hasPending_) return;
+    pending_.where = where;
+    pending_.message = message;
+    hasPending_ = true;
+  }
+
+  /// Input from the start of a failed property to the resync point has
+  /// been skipped, so file the pending failure, or a generic one if
+  /// the property failed without an expectation error
+  void recovered(const boost::iterator_range<Iterator>& skipped) {
+    if (!hasPending_) {
+      pending_.where = skipped.begin();
+      pending_.message = "expected <property>";
+    }
+    failures_.push_back(pending_);
+    hasPending_ = false;
+  }
+
+  const failure_list& failures() const {
+    return failures_;
+  }
+
+  /// Return the unrecovered failure, if any, otherwise nullptr
+  const ParseFailure<Iterator>* pending() const {
+    return hasPending_ ? &pending_ : nullptr;
+  }
+
+ private:
+  failure_list failures_;
+  ParseFailure<Iterator> pending_;
+  bool hasPending_ = false;
+};
+
+/// Checks properties against a compiled Schema as they are parsed.
+/// The enclosing tree is tracked by its constraint index, so each
+/// property costs one perfect hash lookup on (tree, key) plus the checks
+/// of its constraint. Required properties are checked as each tree
+/// closes, and those at the top level by finish().
+template <typename Iterator>
+class SchemaValidator {
+ public:
+  typedef std::vector<ParseFailure<Iterator> > failure_list;
+
+  explicit SchemaValidator(const Schema& schema)
+      : schema_(schema), seen_(schema.size(), false) {
+    stack_.push_back(Frame{Schema::cRoot, Iterator()});
+  }
+
+  /// Mark the start of the next property
+  void start(Iterator where) {
+    where_ = where;
+  }
+
+  /// Look up the constraint for the key of the current property
+  void key(const std::string& k) {
+    const Schema::index_type parent = stack_.back().index;
+    current_ = Schema::cNone;
+    // Contents of unknown trees have already been reported
+    if (parent == Schema::cNone) return;
+
+    const Schema::index_type i = schema_.find(parent, k);
+    if (i == Schema::cNone) {
+      if (!schema_.constraint(parent).open) {
+        fail(where_, "unknown property '" + join(parent, k) + "'");
+      }
+      return;
+    }
+    seen_[i] = true;
+    current_ = i;
+  }
+
+  /// Descend into the tree of the current property
+  void enter() {
+    stack_.push_back(Frame{current_, where_});
+  }
+
+  /// Ascend from the current tree, which closes at where
+  void leave(Iterator where) {
+    const Frame f = stack_.back();
+    stack_.pop_back();
+    if (f.index != Schema::cNone) close(f.index, where);
+    current_ = f.index;
+    where_ = f.where;
+  }
+
+  /// Check the value of the current property
+  void value(const Property::value_type& v) {
+    if (current_ == Schema::cNone) return;
+    std::string message;
+    if (!schema_.check(current_, v, message)) {
+      fail(where_, "property '" + schema_.constraint(current_).path + "' " + message);
+    }
+  }
+
+  /// Check required top-level properties at the end of the document
+  void finish(Iterator where) {
+    close(Schema::cRoot, where);
+  }
+
+  /// Unwind partial state after a failed property
+  void reset() {
+    while (stack_.size() > 1) {
+      if (stack_.back().index != Schema::cNone) clear(stack_.back().index);
+      stack_.pop_back();
+    }
+    current_ = Schema::cNone;
+  }
+
+  const failure_list& failures() const {
+    return failures_;
+  }
+
+ private:
+  struct Frame {
+    Schema::index_type index;
+    Iterator where;
+  };
+
+  std::string join(Schema::index_type parent, const std::string& k) const {
+    return parent == Schema::cRoot ? k : schema_.constraint(parent).path + "." + k;
+  }
+
+  void fail(Iterator where, const std::string& message) {
+    failures_.push_back(ParseFailure<Iterator>{where, message});
+  }
+
+  /// Report missing required properties of tree, and reset the seen
+  /// flags of its children should the same tree appear again
+  void close(Schema::index_type tree, Iterator where) {
+    for (Schema::index_type i : schema_.children(tree)) {
+      if (schema_.constraint(i).required && !seen_[i]) {
+        fail(where, "missing required property '" + schema_.constraint(i).path + "'");
+      }
+      seen_[i] = false;
+    }
+  }
+
+  void clear(Schema::index_type tree) {
+    for (Schema::index_type i : schema_.children(tree)) seen_[i] = false;
+  }
+
+ private:
+  const Schema& schema_;
+  std::vector<bool> seen_;
+  std::vector<Frame> stack_;
+  Schema::index_type current_ = Schema::cNone;
+  Iterator where_;
+  failure_list failures_;
+};
+
+/// Convert the text of a real number matched by qi::double_ using strtod.
+/// Qi's own conversion can be out by an ulp, whereas strtod is correctly
+/// rounded, so reals written with enough digits read back exactly.
+/// Falls back to qi should strtod not accept the text (e.g. because
+/// the C locale uses a different decimal point)
+struct ExactRealImpl {
+  typedef double result_type;
+
+  template <typename Range>
+  double operator()(const Range& text) const {
+    // Numbers are short, so avoid allocating for all sane input
+    char local[64];
+    std::string longer;
+    const char* first(local);
+    const std::size_t n = static_cast<std::size_t>(std::distance(text.begin(), text.end()));
+    if (n < sizeof(local)) {
+      *std::copy(text.begin(), text.end(), local) = '\0';
+    } else {
+      longer.assign(text.begin(), text.end());
+      first = longer.c_str();
+    }
+
+    char* end(nullptr);
+    double value = std::strtod(first, &end);
+    if (end != first + n) {
+      qi::parse(first, first + n, qi::double_, value);
+    }
+    return value;
+  }
+};
+
+/// Convert a quantity's value to SI units, failing unless its unit text
+/// has the required dimension. Empty text is a dimensionless unit
+struct ConvertQuantityImpl {
+  typedef bool result_type;
+
+  template <typename Range>
+  bool operator()(double& value,
+                  const Range& unit,
+                  warwick::units::dimension_code dimension) const {
+    if (unit.begin() == unit.end()) return dimension == warwick::units::cDimensionless;
+    warwick::units::UnitValue u;
+    if (!BoostExamples::get_unit_value(unit.begin(), unit.end(), dimension, u)) return false;
+    value *= u.factor;
+    return true;
+  }
+};
+
+/// Grammar for a typed value, "<typename> = <value>", of a terminal
+/// property node
+template <typename Iterator, typename Skipper>
+class PropertyNodeGrammar
+    : public qi::grammar<Iterator, warwick::Property::value_type(), Skipper> {
+ public:
+  PropertyNodeGrammar() : PropertyNodeGrammar::base_type(start, "typed value") {
     // Nodes are typed values
     // Uses the 'Nabielek Trick' to select a parser for the type
     // parsed by the nodetypes symbol rule.
-    node %= qi::omit[nodetypes[qi::_a = qi::_1]] > '=' > qi::lazy(*qi::_a);
+    // The start rule cannot have locals, hence the extra level
+    start %= node;
+    node %= quantitynode | (qi::omit[nodetypes[qi::_a = qi::_1]] > '=' > qi::lazy(*qi::_a));
 
-    // Tree node does not need a type spec because grammar is
-    // distinct
-    // TODO: allow use of comma separation ala JSON?
-    tree %= '{' > +property >'}';
+    quotedstring %= qi::lexeme['"' >> +(qi::char_ - '"') >> '"'];
 
     // - Node types built of fundamental parsers
     // Integers need a little care so that qi's int_ parser doesn't
@@ -194,9 +486,24 @@ class PropertyGrammar : public qi::grammar<Iterator, warwick::Property(), Skippe
     intnode %= strictint_ | ('[' > strictint_ % "," > ']');
     nodetypes.add("int", &intnode);
 
-    realnode %= qi::double_ | ('[' > qi::double_ % "," > ']');
+    exactreal_ = qi::raw[qi::double_][qi::_val = exactReal_(qi::_1)];
+    realnode %= exactreal_ | ('[' > exactreal_ % "," > ']');
     nodetypes.add("real", &realnode);
 
+    // - Quantities, "real as <dimension>". The unit runs to the end of
+    // the line, a ',' or ']', so skipping is off after the number
+    for (const warwick::units::DimensionName& d : warwick::units::cDimensionNames) {
+      dimensionnames_.add(d.name, d.dimension);
+    }
+    dimension_ %= qi::lexeme[dimensionnames_ >> !(qi::alnum | '_')];
+    unitterm_ = +qi::alpha >> -('^' >> -qi::char_("+-") >> +qi::digit);
+    quantity_ = qi::lexeme[exactreal_[qi::_val = qi::_1] >> -(+qi::blank >> &unitterm_)
+                           >> qi::raw[-(unitterm_ % +qi::blank)]
+                                     [qi::_pass = convertQuantity_(qi::_val, qi::_1, qi::_r1)]];
+    quantitynode %= qi::lit("real") >> "as"
+                    > qi::omit[dimension_[qi::_a = qi::_1]] > '=' > quantityvalue_(qi::_a);
+    quantityvalue_ %= quantity_(qi::_r1) | ('[' > quantity_(qi::_r1) % ',' > ']');
+
     stringnode %= quotedstring | ('[' > quotedstring % ',' > ']');
     nodetypes.add("string", &stringnode);
 
@@ -209,14 +516,152 @@ class PropertyGrammar : public qi::grammar<Iterator, warwick::Property(), Skippe
     bitsetnode %= bitset_;
     nodetypes.add("bitset", &bitsetnode);
 
+    start.name("typed value");
+    node.name("typed value");
+    quotedstring.name("quoted string");
+    intnode.name("int value");
+    realnode.name("real value");
+    dimension_.name("dimension");
+    quantity_.name("real value with a unit of the declared dimension");
+    quantityvalue_.name("quantity value");
+    quantitynode.name("quantity");
+    stringnode.name("string value");
+    boolnode.name("bool value");
+    bitsetnode.name("bitset value");
+  }
+
+ private:
+  typedef qi::rule<Iterator, warwick::Property::value_type(), Skipper> value_rule_t;
+
+  value_rule_t start;
+  qi::rule<Iterator,warwick::Property::value_type(), Skipper,
+      qi::locals<value_rule_t*> > node;
+
+  qi::symbols<char, value_rule_t*> nodetypes;
+
+  /// qi rule for a quoted string
+  qi::rule<Iterator, std::string(), Skipper> quotedstring;
+
+  qi::rule<Iterator, int()> strictint_;
+  qi::rule<Iterator, double()> exactreal_;
+  phx::function<ExactRealImpl> exactReal_;
+  value_rule_t intnode;
+  value_rule_t realnode;
+  qi::symbols<char, warwick::units::dimension_code> dimensionnames_;
+  qi::rule<Iterator, warwick::units::dimension_code(), Skipper> dimension_;
+  qi::rule<Iterator> unitterm_;
+  qi::rule<Iterator, double(warwick::units::dimension_code), Skipper> quantity_;
+  qi::rule<Iterator, warwick::Property::value_type(warwick::units::dimension_code), Skipper>
+      quantityvalue_;
+  phx::function<ConvertQuantityImpl> convertQuantity_;
+  qi::rule<Iterator, warwick::Property::value_type(), Skipper,
+      qi::locals<warwick::units::dimension_code> > quantitynode;
+  value_rule_t stringnode;
+  value_rule_t boolnode;
+  BoostExamples::BitsetParser<Iterator> bitset_;
+  value_rule_t bitsetnode;
+};
+
+template <typename Iterator, typename Skipper>
+class PropertyGrammar : public qi::grammar<Iterator, warwick::Property(), Skipper> {
+ public:
+  /// Construct grammar, optionally collecting descriptions into the
+  /// supplied table, expectation failures into the supplied collector
+  /// rather than reporting them to std::cout, and checking properties
+  /// against a schema with the supplied validator
+  explicit PropertyGrammar(PropertyDescriptions* descriptions = nullptr,
+                           ErrorCollector<Iterator>* errors = nullptr,
+                           SchemaValidator<Iterator>* validator = nullptr)
+      : PropertyGrammar::base_type(property), validator_(validator) {
+    // The fundamental property.
+    // Descriptions are not part of the Property attribute (it would
+    // result in the awkward tuple<Desc, tuple<Id, Value> >), so are
+    // omitted, or routed to the recorder if one was requested
+    if (descriptions || validator) {
+      if (descriptions) recorder_.reset(new DescriptionRecorder(*descriptions));
+      using boost::spirit::repository::qi::iter_pos;
+      property %= qi::omit[-description[phx::bind(&PropertyGrammar::on_describe, this, qi::_1)]]
+                  >> (qi::omit[iter_pos[phx::bind(&PropertyGrammar::on_start, this, qi::_1)]]
+                      >> identifier[phx::bind(&PropertyGrammar::on_key, this, qi::_1)]
+                      > ':'
+                      > assignment[phx::bind(&PropertyGrammar::on_value, this, qi::_1)]);
+      tree %= qi::lit('{')[phx::bind(&PropertyGrammar::on_enter, this)]
+              > +property
+              > (qi::omit[iter_pos[phx::bind(&PropertyGrammar::on_leave, this, qi::_1)]]
+                 >> '}');
+    } else {
+      property %= qi::omit[-description] >> (identifier > ':' > assignment);
+      // Tree node does not need a type spec because grammar is
+      // distinct
+      // TODO: allow use of comma separation ala JSON?
+      tree %= '{' > +property >'}';
+    }
+
+    description %= "@description" > quotedstring;
+
+    identifier %= qi::alpha >> *(qi::alnum | qi::char_('_'));
+    quotedstring %= qi::lexeme['"' >> +(qi::char_ - '"') >> '"'];
+
+    // assignment may be a terminal node or a subtree
+    assignment %= node | tree;
+
     //BOOST_SPIRIT_DEBUG_NODE(property);
     //BOOST_SPIRIT_DEBUG_NODE(typedassignment);
+    property.name("property");
+    identifier.name("identifier");
+    assignment.name("value");
+    tree.name("tree");
+    quotedstring.name("quoted string");
+
     // Because we use expectations, provide simple error handler
-    qi::on_error<qi::fail>(property,
-                           std::cout << phx::val("Error! Expecting ")
-                           << qi::labels::_4
-                           <<std::endl
-                           );
+    if (errors) {
+      qi::on_error<qi::fail>(property,
+                             phx::bind(&ErrorCollector<Iterator>::expected,
+                                       phx::ref(*errors),
+                                       qi::labels::_3,
+                                       qi::labels::_4));
+    } else {
+      qi::on_error<qi::fail>(property,
+                             std::cout << phx::val("Error! Expecting ")
+                             << qi::labels::_4
+                             <<std::endl
+                             );
+    }
+  }
+
+  /// Discard partial state after a failed property
+  void reset() {
+    if (recorder_) recorder_->reset();
+    if (validator_) validator_->reset();
+  }
+
+ private:
+  // Observers of the parse, forwarding to the recorder and validator
+  void on_describe(const std::string& text) {
+    if (recorder_) recorder_->describe(text);
+  }
+
+  void on_start(Iterator where) {
+    if (validator_) validator_->start(where);
+  }
+
+  void on_key(const std::string& k) {
+    if (recorder_) recorder_->key(k);
+    if (validator_) validator_->key(k);
+  }
+
+  void on_enter() {
+    if (recorder_) recorder_->enter();
+    if (validator_) validator_->enter();
+  }
+
+  void on_leave(Iterator where) {
+    if (recorder_) recorder_->leave();
+    if (validator_) validator_->leave(where);
+  }
+
+  void on_value(const warwick::Property::value_type& v) {
+    if (validator_) validator_->value(v);
   }
 
  private:
@@ -237,19 +682,11 @@ class PropertyGrammar : public qi::grammar<Iterator, warwick::Property(), Skippe
 
 
   value_rule_t assignment;
-  qi::rule<Iterator,warwick::Property::value_type(), Skipper,
-      qi::locals<value_rule_t*> > node;
+  PropertyNodeGrammar<Iterator, Skipper> node;
   tree_rule_t tree;
 
-  qi::symbols<char, value_rule_t*> nodetypes;
-
-  qi::rule<Iterator, int()> strictint_;
-  value_rule_t intnode;
-  value_rule_t realnode;
-  value_rule_t stringnode;
-  value_rule_t boolnode;
-  BoostExamples::BitsetParser<Iterator> bitset_;
-  value_rule_t bitsetnode;
+  std::unique_ptr<DescriptionRecorder> recorder_;
+  SchemaValidator<Iterator>* validator_;
 };
 
 
@@ -259,18 +696,62 @@ class PropertyGrammar : public qi::grammar<Iterator, warwick::Property(), Skippe
 // This is distinct, because otherwise we'd have to always have a root
 // node for the tree and Properties allow a flat namespace (i.e. implicit
 // unamed root node)
+//
+// In recovery mode, a property that fails to parse is skipped up to the
+// next top-level identifier, i.e. the next line starting with
+// "<identifier> :" or "@description" outside of any braces opened by the
+// failed property. Parsing then resumes, so all errors in a document are
+// found in one pass, leaving a partial PropertyList of the good entries.
+// An unbalanced '{' in a failed property consumes the rest of the input.
 template <typename Iterator, typename Skipper>
 class PropertyListGrammar :
     public qi::grammar<Iterator, warwick::PropertyList(), Skipper> {
  public:
-  PropertyListGrammar() : PropertyListGrammar::base_type(document) {
-    document %= *property;
+  /// Construct grammar, optionally collecting descriptions. If an error
+  /// collector is supplied, the grammar records failures into it, and
+  /// recovers from them unless recovering is false. If a validator is
+  /// supplied, properties are checked against its schema as they are
+  /// parsed.
+  explicit PropertyListGrammar(PropertyDescriptions* descriptions = nullptr,
+                               ErrorCollector<Iterator>* errors = nullptr,
+                               bool recovering = true,
+                               SchemaValidator<Iterator>* validator = nullptr)
+      : PropertyListGrammar::base_type(document),
+        property(descriptions, errors, validator) {
+    if (errors && recovering) {
+      // Only push complete properties, as a failed one may have left
+      // a partial attribute behind
+      document = *(property[phx::push_back(qi::_val, qi::_1)] | recover);
+
+      recover = qi::raw[resync][phx::bind(&ErrorCollector<Iterator>::recovered,
+                                          phx::ref(*errors),
+                                          qi::_1)
+                                ,phx::bind(&PropertyGrammar<Iterator, Skipper>::reset,
+                                           phx::ref(property))];
+
+      // Consume at least one token, tracking brace depth (_a) and ignoring
+      // braces inside strings and comments, until a top-level line start
+      resync = qi::eps[qi::_a = 0]
+               >> +(!(qi::eps(qi::_a <= 0) >> qi::eol >> *qi::blank >> toplevel)
+                    >> (('"' >> *(qi::char_ - '"') >> -qi::lit('"'))
+                        | ('#' >> *(qi::char_ - qi::eol))
+                        | qi::lit('{')[++qi::_a]
+                        | qi::lit('}')[--qi::_a]
+                        | qi::char_));
+      toplevel = qi::lit("@description")
+                 | (qi::alpha >> *(qi::alnum | '_') >> *qi::blank >> ':');
+    } else {
+      document %= *property;
+    }
     //BOOST_SPIRIT_DEBUG_NODE(document);
   }
 
  private:
   PropertyGrammar<Iterator, Skipper> property;
   qi::rule<Iterator, warwick::PropertyList(), Skipper> document;
+  qi::rule<Iterator, Skipper> recover;
+  qi::rule<Iterator, qi::locals<int> > resync;
+  qi::rule<Iterator> toplevel;
 };
 
 
@@ -289,3 +770,4 @@ struct PropertySkipper : public qi::grammar<Iterator> {
 
 } // namespace warwick
 
+#endif // PROPERTYGRAMMAR_HH
@@ -0,0 +1,193 @@
+// - PropertyHash.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyHash.hpp"
+
+// Standard Library
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace warwick {
+namespace {
+/// Bits of a real in the canonical encoding, with a single NaN
+std::uint64_t real_bits(double value) {
+  std::uint64_t bits(0x7ff8000000000000ULL);
+  if (!std::isnan(value)) std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+/// FNV-1a over the canonical encoding. Multi-byte values are fed least
+/// significant byte first whatever the host byte order.
+class Hasher {
+ public:
+  explicit Hasher(char tag) : h_(14695981039346656037ULL) {
+    byte(static_cast<unsigned char>(tag));
+  }
+
+  void byte(unsigned char b) {
+    h_ ^= b;
+    h_ *= 1099511628211ULL;
+  }
+
+  void u64(std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) byte(static_cast<unsigned char>(v >> (8 * i)));
+  }
+
+  void bytes(const std::string& s) {
+    u64(s.size());
+    for (char c : s) byte(static_cast<unsigned char>(c));
+  }
+
+  /// Final avalanche (the splitmix64 finaliser), so that the low bits
+  /// used by hash tables depend on every input byte
+  std::uint64_t value() const {
+    std::uint64_t z = h_;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+ private:
+  std::uint64_t h_;
+};
+} // namespace
+
+class DocumentHasher : public boost::static_visitor<void> {
+ public:
+  DocumentHasher(Hasher& hasher, DocumentHash* index) : hasher_(hasher), index_(index) {}
+
+  void operator()(int value) const {
+    hasher_.u64(static_cast<std::uint64_t>(static_cast<std::int64_t>(value)));
+  }
+
+  void operator()(double value) const {
+    hasher_.u64(real_bits(value));
+  }
+
+  void operator()(bool value) const {
+    hasher_.byte(value ? 1 : 0);
+  }
+
+  void operator()(const std::string& value) const {
+    hasher_.bytes(value);
+  }
+
+  void operator()(const boost::dynamic_bitset<>& value) const {
+    hasher_.u64(value.size());
+    for (std::size_t i = 0; i < value.size(); i += 8) {
+      unsigned char b(0);
+      for (std::size_t j = i; j < i + 8 && j < value.size(); ++j) {
+        if (value[j]) b |= static_cast<unsigned char>(1u << (j - i));
+      }
+      hasher_.byte(b);
+    }
+  }
+
+  template <typename T>
+  void operator()(const std::vector<T>& value) const {
+    hasher_.u64(value.size());
+    for (const T& v : value) (*this)(v);
+  }
+
+  void operator()(const PropertyList& value) const {
+    hasher_.u64(list(value, index_));
+  }
+
+  /// Hash of list, recording its properties in index if given
+  static std::uint64_t list(const PropertyList& list, DocumentHash* index) {
+    Hasher h('D');
+    h.u64(list.size());
+    for (const Property& p : list) h.u64(property(p, index));
+    return h.value();
+  }
+
+  static std::uint64_t property(const Property& p, DocumentHash* index) {
+    const std::size_t at = index ? index->hash_.size() : 0;
+    if (index) {
+      index->hash_.push_back(0);
+      index->size_.push_back(0);
+    }
+
+    Hasher h('P');
+    h.bytes(p.Key);
+    h.byte(static_cast<unsigned char>(p.Value.which()));
+    boost::apply_visitor(DocumentHasher(h, index), p.Value);
+
+    if (index) {
+      index->hash_[at] = h.value();
+      index->size_[at] = index->hash_.size() - at;
+    }
+    return h.value();
+  }
+
+ private:
+  Hasher& hasher_;
+  DocumentHash* index_;
+};
+
+namespace {
+/// Compares a value with another of the same type
+class SameValue : public boost::static_visitor<bool> {
+ public:
+  explicit SameValue(const Property::value_type& other) : other_(other) {}
+
+  template <typename T>
+  bool operator()(const T& value) const {
+    return value == boost::get<T>(other_);
+  }
+
+  bool operator()(double value) const {
+    return real_bits(value) == real_bits(boost::get<double>(other_));
+  }
+
+  bool operator()(const std::vector<double>& value) const {
+    const std::vector<double>& other = boost::get<std::vector<double> >(other_);
+    if (value.size() != other.size()) return false;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (real_bits(value[i]) != real_bits(other[i])) return false;
+    }
+    return true;
+  }
+
+  bool operator()(const PropertyList& value) const {
+    return same_document(value, boost::get<PropertyList>(other_));
+  }
+
+ private:
+  const Property::value_type& other_;
+};
+} // namespace
+
+bool same_property(const Property& a, const Property& b) {
+  return a.Key == b.Key && a.Value.which() == b.Value.which() &&
+         boost::apply_visitor(SameValue(b.Value), a.Value);
+}
+
+bool same_document(const PropertyList& a, const PropertyList& b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (!same_property(a[i], b[i])) return false;
+  }
+  return true;
+}
+
+std::uint64_t hash_property(const Property& property) {
+  return DocumentHasher::property(property, nullptr);
+}
+
+std::uint64_t hash_document(const PropertyList& document) {
+  return DocumentHasher::list(document, nullptr);
+}
+
+DocumentHash::DocumentHash(const PropertyList& document) {
+  root_ = DocumentHasher::list(document, this);
+}
+} // namespace warwick
@@ -0,0 +1,94 @@
+// PropertyHash - stable content hashes of properties and documents
+//
+// Hashes are computed bottom-up: a tree's hash covers the hashes of its
+// properties rather than their contents, so every subtree has its own
+// hash and two documents can be compared, or used as a cache key, by
+// comparing 64 bit numbers.
+//
+// Values are hashed through a canonical encoding - integers as 64 bit
+// little-endian, reals by their IEEE 754 bits (with a single NaN),
+// strings, bitsets and arrays prefixed by their length - with FNV-1a
+// and a final avalanche step. The hashes therefore do not depend on the
+// platform, compiler or run, and may be stored as persistent keys.
+//
+// DocumentHash keeps the hash of every property in pre-order, together
+// with the size of its subtree, so diffs and caches that need subtree
+// hashes compute them once per document.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYHASH_HH
+#define PROPERTYHASH_HH
+
+// Standard Library
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// This Project
+#include "Property.hpp"
+
+namespace warwick {
+/// Hash of key and value of property
+std::uint64_t hash_property(const Property& property);
+
+/// Hash of the properties of document, in order
+std::uint64_t hash_document(const PropertyList& document);
+
+/// True if a and b have the same content, as the hashes encode it (so
+/// reals compare by their bits, with all NaNs equal). Equal hashes make
+/// this likely but do not prove it, so use it to confirm a match
+bool same_property(const Property& a, const Property& b);
+
+bool same_document(const PropertyList& a, const PropertyList& b);
+
+/// Hashes of a document and all of its subtrees
+class DocumentHash {
+ public:
+  DocumentHash() : root_(hash_document(PropertyList())) {}
+  explicit DocumentHash(const PropertyList& document);
+
+  /// Hash of the whole document, as hash_document
+  std::uint64_t root() const {
+    return root_;
+  }
+
+  /// Number of properties in the document, at any depth
+  std::size_t size() const {
+    return hash_.size();
+  }
+
+  /// Hash of the i'th property in pre-order, as hash_property
+  std::uint64_t hash(std::size_t i) const {
+    return hash_[i];
+  }
+
+  /// Number of properties in the subtree of the i'th property, itself
+  /// included, so that i + subtree_size(i) is its next sibling
+  std::size_t subtree_size(std::size_t i) const {
+    return size_[i];
+  }
+
+ private:
+  friend class DocumentHasher;
+
+  std::uint64_t root_;
+  std::vector<std::uint64_t> hash_;
+  std::vector<std::size_t> size_;
+};
+
+inline bool operator==(const DocumentHash& a, const DocumentHash& b) {
+  return a.root() == b.root();
+}
+
+inline bool operator!=(const DocumentHash& a, const DocumentHash& b) {
+  return a.root() != b.root();
+}
+} // namespace warwick
+
+#endif // PROPERTYHASH_HH
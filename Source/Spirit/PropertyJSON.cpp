@@ -0,0 +1,303 @@
+// - PropertyJSON.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyJSON.hpp"
+
+// Standard Library
+#include <cmath>
+#include <istream>
+#include <iterator>
+
+// This Project
+#include "LineIndex.hpp"
+#include "PropertyGrammar.hpp"
+
+namespace warwick {
+namespace {
+const char cHexDigits[] = "0123456789abcdef";
+
+//----------------------------------------------------------------------
+// Writer
+class JSONWriter : public boost::static_visitor<bool> {
+ public:
+  JSONWriter(OutputBuffer& out, std::size_t depth) : out_(out), depth_(depth) {}
+
+  bool object(const PropertyList& list) {
+    if (list.empty()) {
+      out_.append("{}", 2);
+      return true;
+    }
+    out_.append("{\n", 2);
+    JSONWriter inner(out_, depth_ + 1);
+    for (std::size_t i = 0; i < list.size(); ++i) {
+      if (i) out_.append(",\n", 2);
+      out_.append(2 * (depth_ + 1), ' ');
+      append_json_string(out_, list[i].Key);
+      out_.append(": ", 2);
+      if (!boost::apply_visitor(inner, list[i].Value)) return false;
+      out_.maybe_flush();
+    }
+    out_.append('\n');
+    out_.append(2 * depth_, ' ');
+    out_.append('}');
+    return true;
+  }
+
+  bool operator()(int value) const {
+    out_.append_int(value);
+    return true;
+  }
+
+  bool operator()(double value) const {
+    if (!std::isfinite(value)) return false;
+    out_.append_real(value, true);
+    return true;
+  }
+
+  bool operator()(bool value) const {
+    value ? out_.append("true", 4) : out_.append("false", 5);
+    return true;
+  }
+
+  bool operator()(const std::string& value) const {
+    append_json_string(out_, value);
+    return true;
+  }
+
+  bool operator()(const boost::dynamic_bitset<>& value) const {
+    out_.append("\"0b", 3);
+    for (std::size_t i = value.size(); i > 0; --i) {
+      out_.append(value[i - 1] ? '1' : '0');
+    }
+    out_.append('"');
+    return true;
+  }
+
+  template <typename T>
+  bool operator()(const std::vector<T>& value) const {
+    out_.append('[');
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (i) out_.append(", ", 2);
+      if (!(*this)(value[i])) return false;
+      out_.maybe_flush();
+    }
+    out_.append(']');
+    return true;
+  }
+
+  bool operator()(const PropertyList& value) const {
+    return JSONWriter(out_, depth_).object(value);
+  }
+
+ private:
+  OutputBuffer& out_;
+  std::size_t depth_;
+};
+
+bool write_document(const PropertyList& document, OutputBuffer& out) {
+  if (!JSONWriter(out, 0).object(document)) return false;
+  out.append('\n');
+  return true;
+}
+
+//----------------------------------------------------------------------
+// Reader
+/// Append a Unicode code point to a string as UTF-8
+struct AppendUTF8Impl {
+  typedef void result_type;
+
+  void operator()(std::string& s, unsigned int cp) const {
+    if (cp < 0x80) {
+      s += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+      s += static_cast<char>(0xC0 | (cp >> 6));
+      s += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      s += static_cast<char>(0xE0 | (cp >> 12));
+      s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      s += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+      s += static_cast<char>(0xF0 | (cp >> 18));
+      s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+      s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      s += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+  }
+};
+
+struct MakeBitsetImpl {
+  typedef boost::dynamic_bitset<> result_type;
+
+  template <typename Range>
+  boost::dynamic_bitset<> operator()(const Range& digits) const {
+    return boost::dynamic_bitset<>(std::string(digits.begin(), digits.end()));
+  }
+};
+
+/// Grammar mapping a JSON object onto a PropertyList
+template <typename Iterator, typename Skipper>
+class JSONGrammar : public qi::grammar<Iterator, PropertyList(), Skipper> {
+ public:
+  explicit JSONGrammar(ErrorCollector<Iterator>& errors)
+      : JSONGrammar::base_type(document, "JSON document") {
+    using qi::_1;
+    using qi::_val;
+    using qi::lit;
+
+    document %= object;
+    object %= lit('{') > -(member % ',') > '}';
+    member %= jstring > ':' > value;
+
+    value = object[_val = _1]
+            | (lit('[') > items[_val = _1] > ']')
+            | bitset[_val = _1]
+            | jstring[_val = _1]
+            | integer[_val = _1]
+            | number[_val = _1]
+            | qi::bool_[_val = _1];
+
+    items = (intarray >> &lit(']'))[_val = _1]
+            | (realarray >> &lit(']'))[_val = _1]
+            | (stringarray >> &lit(']'))[_val = _1];
+    intarray %= integer % ',';
+    realarray %= number % ',';
+    stringarray %= jstring % ',';
+
+    // Integers are numbers without fraction or exponent, that fit an int
+    integer %= qi::lexeme[qi::int_ >> !qi::char_(".eE0-9")];
+    number = qi::raw[qi::lexeme[-lit('-') >> +qi::digit >> -('.' >> +qi::digit) >>
+                                -(qi::char_("eE") >> -qi::char_("+-") >> +qi::digit)]]
+                 [_val = exactReal_(_1)];
+
+    bitset = qi::lexeme['"' >> lit("0b") >>
+                        qi::raw[qi::repeat(1, 64)[qi::char_("01")]] >> '"']
+                 [_val = makeBitset_(_1)];
+
+    escapes.add("\"", '"')("\\", '\\')("/", '/')("b", '\b')("f", '\f')
+               ("n", '\n')("r", '\r')("t", '\t');
+    jstring = qi::lexeme['"' > *(('\\' > (escapes[phx::push_back(_val, _1)]
+                                          | ('u' > codepoint[appendUTF8_(_val, _1)])))
+                                 | (qi::char_ - '"' - '\\' - qi::char_('\0', '\x1f'))
+                                       [phx::push_back(_val, _1)])
+                         > '"'];
+    // Surrogate pairs combine into a single code point, and surrogates
+    // are otherwise invalid
+    codepoint = (hex4[_val = _1] >> qi::eps(_val < 0xD800u || _val >= 0xE000u))
+                | (hex4[_val = _1] >> qi::eps(_val < 0xDC00u) > lit("\\u") >
+                   lowsurrogate[_val = 0x10000u + ((_val - 0xD800u) << 10) + (_1 - 0xDC00u)]);
+    lowsurrogate = hex4[_val = _1] >> qi::eps(_val >= 0xDC00u && _val < 0xE000u);
+
+    object.name("object");
+    member.name("member");
+    value.name("value");
+    items.name("non-empty array of numbers or strings");
+    jstring.name("string");
+    codepoint.name("4 hex digits, not a low surrogate");
+    lowsurrogate.name("low surrogate");
+
+    qi::on_error<qi::fail>(document,
+                           phx::bind(&ErrorCollector<Iterator>::expected,
+                                     phx::ref(errors),
+                                     qi::labels::_3,
+                                     qi::labels::_4));
+  }
+
+ private:
+  qi::rule<Iterator, PropertyList(), Skipper> document, object;
+  qi::rule<Iterator, Property(), Skipper> member;
+  qi::rule<Iterator, Property::value_type(), Skipper> value, items;
+  qi::rule<Iterator, std::vector<int>(), Skipper> intarray;
+  qi::rule<Iterator, std::vector<double>(), Skipper> realarray;
+  qi::rule<Iterator, std::vector<std::string>(), Skipper> stringarray;
+  qi::rule<Iterator, int(), Skipper> integer;
+  qi::rule<Iterator, double(), Skipper> number;
+  qi::rule<Iterator, boost::dynamic_bitset<>(), Skipper> bitset;
+  qi::rule<Iterator, std::string(), Skipper> jstring;
+  qi::rule<Iterator, unsigned int()> codepoint, lowsurrogate;
+  qi::uint_parser<unsigned int, 16, 4, 4> hex4;
+  qi::symbols<char, char> escapes;
+  phx::function<ExactRealImpl> exactReal_;
+  phx::function<MakeBitsetImpl> makeBitset_;
+  phx::function<AppendUTF8Impl> appendUTF8_;
+};
+} // namespace
+
+void append_json_string(OutputBuffer& out, const std::string& s) {
+  out.append('"');
+  std::size_t run(0);
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+    // Copy the unescaped run before c in one go
+    out.append(s.data() + run, i - run);
+    run = i + 1;
+    switch (c) {
+      case '"': out.append("\\\"", 2); break;
+      case '\\': out.append("\\\\", 2); break;
+      case '\n': out.append("\\n", 2); break;
+      case '\r': out.append("\\r", 2); break;
+      case '\t': out.append("\\t", 2); break;
+      default: {
+        const char escaped[] = {'\\', 'u', '0', '0', cHexDigits[c >> 4], cHexDigits[c & 0xF]};
+        out.append(escaped, sizeof(escaped));
+      }
+    }
+  }
+  out.append(s.data() + run, s.size() - run);
+  out.append('"');
+}
+
+bool write_json(const PropertyList& document, std::string& buffer) {
+  OutputBuffer out(buffer);
+  return write_document(document, out);
+}
+
+bool write_json(const PropertyList& document, std::ostream& os) {
+  OutputBuffer out(os);
+  return write_document(document, out);
+}
+
+bool read_json(const std::string& text, PropertyList& output, ParseError& error) {
+  typedef std::string::const_iterator Iterator;
+  typedef qi::standard::space_type Skipper;
+
+  ErrorCollector<Iterator> errors;
+  JSONGrammar<Iterator, Skipper> grammar(errors);
+  Iterator first(text.begin());
+  PropertyList result;
+  bool ok = qi::phrase_parse(first, text.end(), grammar, qi::standard::space, result);
+  if (ok && first != text.end()) {
+    errors.fail(first, "expected end of input");
+    ok = false;
+  } else if (!ok) {
+    errors.fail(first, "expected object");
+  }
+
+  if (!ok) {
+    // The collector keeps the innermost failure if there is one
+    const ParseFailure<Iterator>* failure = errors.pending();
+    TextPosition pos = LineIndex(text).locate(
+        static_cast<std::size_t>(failure->where - text.begin()));
+    error.line = pos.line;
+    error.column = pos.column;
+    error.message = failure->message;
+    return false;
+  }
+  output.swap(result);
+  return true;
+}
+
+bool read_json(std::istream& input, PropertyList& output, ParseError& error) {
+  return read_json(std::string((std::istreambuf_iterator<char>(input)),
+                               std::istreambuf_iterator<char>()),
+                   output,
+                   error);
+}
+} // namespace warwick
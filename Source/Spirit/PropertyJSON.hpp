@@ -0,0 +1,56 @@
+// PropertyJSON - direct conversion between PropertyLists and JSON
+//
+// write_json streams a PropertyList out as JSON text without building
+// any intermediate tree, so it needs only constant extra memory beyond
+// the output block when writing to an ostream. Trees become objects
+// (keeping document order), arrays become JSON arrays, reals always carry
+// a decimal point or exponent, and bitsets become strings of the form
+// "0b0110" (most significant bit first).
+//
+// read_json is the inverse, parsing a JSON object straight into a
+// PropertyList. As Property values are typed, JSON arrays must be
+// non-empty and homogeneous: all integers, all numbers (read as reals)
+// or all strings. Integers too large for an int are read as reals,
+// strings of the form "0b[01]+" (up to 64 digits) are read as bitsets,
+// and null is not accepted.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYJSON_HH
+#define PROPERTYJSON_HH
+
+// Standard Library
+#include <iosfwd>
+#include <string>
+
+// This Project
+#include "OutputBuffer.hpp"
+#include "Property.hpp"
+#include "PropertyParser.hpp"
+
+namespace warwick {
+/// Append JSON text for document to buffer. Returns false if the
+/// document holds a non-finite real, which JSON cannot represent.
+bool write_json(const PropertyList& document, std::string& buffer);
+
+/// Write JSON text for document to os
+bool write_json(const PropertyList& document, std::ostream& os);
+
+/// Parse the JSON object in text into output, returning false and
+/// filling error if text is not an object that maps onto Properties
+bool read_json(const std::string& text, PropertyList& output, ParseError& error);
+
+/// Parse the JSON object read from input into output
+bool read_json(std::istream& input, PropertyList& output, ParseError& error);
+
+/// Append s to out as a double quoted JSON string, escaping '"', '\'
+/// and control characters. Also valid as a YAML double quoted scalar.
+void append_json_string(OutputBuffer& out, const std::string& s);
+} // namespace warwick
+
+#endif // PROPERTYJSON_HH
@@ -11,99 +11,228 @@
 #include "PropertyParser.hpp"
 
 // Standard Library
+#include <algorithm>
+#include <iterator>
+#include <memory>
 
 // Third Party
 // - A
 
 // This Project
 #include "PropertyGrammar.hpp"
-#include <boost/spirit/include/support_istream_iterator.hpp>
+#include "IterativePropertyParser.hpp"
+#include "LineIndex.hpp"
+#include "ParseCache.hpp"
+
+namespace {
+// All frontends parse from an in-memory buffer. This is faster than
+// spirit's multi_pass istream_iterator, and lets failures be mapped
+// back to a line and column.
+typedef std::string::const_iterator Iterator;
+typedef warwick::PropertySkipper<Iterator> Skipper;
+typedef warwick::ErrorCollector<Iterator> Collector;
+
+std::string read_input(std::istream& input) {
+  return std::string((std::istreambuf_iterator<char>(input)),
+                     std::istreambuf_iterator<char>());
+}
 
-bool parse_string(const std::string& input, warwick::Property& output) {
-  typedef std::string::const_iterator Iterator;
-  typedef warwick::PropertySkipper<Iterator> Skipper;
-  typedef warwick::PropertyGrammar<Iterator, Skipper> Grammar;
+/// Report why a non-recovering parse of buffer stopped at first
+void report_failure(const std::string& buffer,
+                    Iterator first,
+                    const Collector& collector) {
+  const warwick::ParseFailure<Iterator>* failure = collector.pending();
+  Iterator where = failure ? failure->where : first;
+  const std::size_t offset = static_cast<std::size_t>(where - buffer.begin());
+
+  warwick::LineIndex index(buffer);
+  warwick::TextPosition pos = index.locate(offset);
+
+  std::cerr << "No complete parse, at line " << pos.line
+            << ", column " << pos.column;
+  if (failure) {
+    std::cerr << ": " << failure->message;
+  }
+  std::cerr << std::endl;
+  std::cerr << "  " << index.line_text(offset) << std::endl;
+  std::cerr << "  " << std::string(pos.column - 1, ' ') << "^" << std::endl;
+}
 
-  Iterator first(input.begin());
-  Iterator last(input.end());
+template <typename Grammar, typename Attribute>
+bool parse_buffer(const std::string& buffer,
+                  const Grammar& grammar,
+                  const Collector& collector,
+                  Attribute& output) {
+  Iterator first(buffer.begin());
+  Iterator last(buffer.end());
 
-  // apply eoi after property parser because here there should be
-  // no trailing input
   bool result = warwick::qi::phrase_parse(first,
       last,
-      Grammar() > warwick::qi::eoi,
+      grammar,
       Skipper(),
       output
       );
 
-  // Handle incomplete parse
-  if (first != last) {
-    std::cerr << "No complete parse of \"" << input << "\"" << std::endl;
-    std::cerr << "Dangling input:" << std::endl;
-    std::copy(first,last,std::ostream_iterator<const char>(std::cerr));
-    std::cerr << std::endl;
+  // Handle incomplete parse. Position lookup happens only here, so
+  // successful parses pay nothing for it
+  if (!result || first != last) {
+    report_failure(buffer, first, collector);
     return false;
   }
 
   return result;
 }
+} // namespace
+
+bool parse_string(const std::string& input, warwick::Property& output) {
+  typedef warwick::PropertyGrammar<Iterator, Skipper> Grammar;
+  Collector collector;
+  return parse_buffer(input, Grammar(nullptr, &collector), collector, output);
+}
 
 
 bool parse_istream(std::istream& input, warwick::Property& output) {
-  typedef boost::spirit::istream_iterator Iterator;
-  typedef warwick::PropertySkipper<Iterator> Skipper;
   typedef warwick::PropertyGrammar<Iterator, Skipper> Grammar;
+  const std::string buffer = read_input(input);
+  Collector collector;
+  return parse_buffer(buffer, Grammar(nullptr, &collector), collector, output);
+}
 
-  Iterator first(input);
-  Iterator last;
-
-  // apply eoi after property parser because here there should be
-  // no trailing input
-  bool result = warwick::qi::phrase_parse(first,
-      last,
-      Grammar() > warwick::qi::eoi,
-      Skipper(),
-      output
-      );
+bool parse_document(std::istream& input, warwick::PropertyList& output) {
+  typedef warwick::PropertyListGrammar<Iterator, Skipper> Grammar;
+  const std::string buffer = read_input(input);
+  warwick::ParseCache* cache = warwick::parse_cache();
+  if (cache && cache->load(buffer, output)) return true;
 
-  // Handle incomplete parse
-  if (first != last) {
-    std::cerr << "No complete parse of \"" << &input << "\"" << std::endl;
-    std::cerr << "Dangling input:" << std::endl;
-    std::copy(first,last,std::ostream_iterator<const char>(std::cerr));
-    std::cerr << std::endl;
+  Collector collector;
+  warwick::PropertyList document;
+  if (!parse_buffer(buffer, Grammar(nullptr, &collector, false), collector, document)) {
     return false;
   }
+  if (cache) cache->store(buffer, document);
+  output.insert(output.end(),
+                std::make_move_iterator(document.begin()),
+                std::make_move_iterator(document.end()));
+  return true;
+}
 
+bool parse_document(std::istream& input,
+                    warwick::PropertyList& output,
+                    warwick::PropertyDescriptions& descriptions) {
+  typedef warwick::PropertyListGrammar<Iterator, Skipper> Grammar;
+  const std::string buffer = read_input(input);
+  Collector collector;
+  return parse_buffer(buffer,
+                      Grammar(&descriptions, &collector, false),
+                      collector,
+                      output);
+}
+
+bool parse_document_iterative(std::istream& input,
+                              warwick::PropertyList& output,
+                              std::size_t maxDepth) {
+  typedef warwick::IterativePropertyListParser<Iterator, Skipper> Parser;
+  const std::string buffer = read_input(input);
+  Iterator first(buffer.begin());
+  Iterator last(buffer.end());
+
+  Collector collector;
+  bool result = Parser(maxDepth).parse(first, last, output, collector);
+
+  if (!result || first != last) {
+    report_failure(buffer, first, collector);
+    return false;
+  }
   return result;
 }
 
-bool parse_document(std::istream& input, warwick::PropertyList& output) {
-  typedef boost::spirit::istream_iterator Iterator;
-  typedef warwick::PropertySkipper<Iterator> Skipper;
+namespace {
+bool parse_recovering(std::istream& input,
+                      warwick::PropertyList& output,
+                      warwick::PropertyDescriptions* descriptions,
+                      const warwick::Schema* schema,
+                      warwick::ParseErrorList& errors) {
   typedef warwick::PropertyListGrammar<Iterator, Skipper> Grammar;
+  typedef warwick::SchemaValidator<Iterator> Validator;
+
+  const std::string buffer = read_input(input);
+
+  // Only plain parses are cached, as descriptions and schema failures
+  // are not part of the stored document
+  warwick::ParseCache* cache = descriptions || schema ? nullptr : warwick::parse_cache();
+  if (cache && cache->load(buffer, output)) return true;
+  const std::size_t existing = output.size();
 
-  Iterator first(input);
-  Iterator last;
+  Iterator first(buffer.begin());
+  Iterator last(buffer.end());
 
-  // apply eoi after property parser because here there should be
-  // no trailing input
+  Collector collector;
+  std::unique_ptr<Validator> validator(schema ? new Validator(*schema) : nullptr);
   bool result = warwick::qi::phrase_parse(first,
       last,
-      Grammar(),
+      Grammar(descriptions, &collector, true, validator.get()),
       Skipper(),
       output
       );
 
-  // Handle incomplete parse
+  // Syntax errors and schema violations are reported in document order
+  Collector::failure_list failures(collector.failures());
+  if (validator) {
+    validator->finish(last);
+    failures.insert(failures.end(),
+                    validator->failures().begin(),
+                    validator->failures().end());
+    std::stable_sort(failures.begin(), failures.end(),
+                     [](const warwick::ParseFailure<Iterator>& a,
+                        const warwick::ParseFailure<Iterator>& b) {
+                       return a.where < b.where;
+                     });
+  }
+
+  warwick::LineIndex index(buffer);
+  auto report = [&](Iterator where, const std::string& message) {
+    warwick::TextPosition pos =
+        index.locate(static_cast<std::size_t>(where - buffer.begin()));
+    warwick::ParseError e;
+    e.line = pos.line;
+    e.column = pos.column;
+    e.message = message;
+    errors.push_back(e);
+  };
+
+  for (const auto& f : failures) {
+    report(f.where, f.message);
+  }
+
+  // Anything left over is trailing input the recovery could not consume
   if (first != last) {
-    std::cerr << "No complete parse of \"" << &input << "\"" << std::endl;
-    std::cerr << "Dangling input:" << std::endl;
-    //std::copy(first,last,std::ostream_iterator<const char>(std::cerr));
-    std::cerr << std::endl;
-    return false;
+    report(first, "unexpected trailing input");
   }
 
-  return result;
+  if (!(result && errors.empty())) return false;
+  if (cache) {
+    cache->store(buffer, warwick::PropertyList(output.begin() + existing, output.end()));
+  }
+  return true;
 }
+} // namespace
 
+bool parse_document(std::istream& input,
+                    warwick::PropertyList& output,
+                    warwick::ParseErrorList& errors) {
+  return parse_recovering(input, output, nullptr, nullptr, errors);
+}
+
+bool parse_document(std::istream& input,
+                    warwick::PropertyList& output,
+                    warwick::PropertyDescriptions& descriptions,
+                    warwick::ParseErrorList& errors) {
+  return parse_recovering(input, output, &descriptions, nullptr, errors);
+}
+
+bool parse_document(std::istream& input,
+                    warwick::PropertyList& output,
+                    const warwick::Schema& schema,
+                    warwick::ParseErrorList& errors) {
+  return parse_recovering(input, output, nullptr, &schema, errors);
+}
@@ -11,7 +11,10 @@
 #define PROPERTYPARSER_HH
 
 // Standard Library
+#include <cstddef>
+#include <iosfwd>
 #include <string>
+#include <vector>
 
 // Third Party
 // - A
@@ -19,6 +22,25 @@
 // This Project
 #include "Property.hpp"
 
+namespace warwick {
+/// Location (1-based) and description of an error found when parsing
+struct ParseError {
+  std::size_t line;
+  std::size_t column;
+  std::string message;
+};
+
+typedef std::vector<ParseError> ParseErrorList;
+
+class Schema;
+} // namespace warwick
+
+// The following report failures to std::cerr, giving the line and
+// column at which the parse stopped
+//
+// The parse_document frontends without descriptions or a schema consult
+// the ParseCache installed with warwick::set_parse_cache(), if any
+
 /// Parse input string using property grammar, returning true on success
 bool parse_string(const std::string& input, warwick::Property& output);
 
@@ -28,5 +50,44 @@ bool parse_istream(std::istream& input, warwick::Property& output);
 /// Parse input istream using document grammar, returning true on success
 bool parse_document(std::istream& input, warwick::PropertyList& output);
 
+/// Parse input istream using document grammar, returning true on success
+/// Any "@description" entries are collected into the descriptions table,
+/// keyed by the dotted path of the property they precede
+bool parse_document(std::istream& input,
+                    warwick::PropertyList& output,
+                    warwick::PropertyDescriptions& descriptions);
+
+/// Parse input istream as a document without recursing on nested trees,
+/// so that deeply nested input cannot exhaust the stack. Fails if trees
+/// nest deeper than maxDepth. Returns true on success
+bool parse_document_iterative(std::istream& input,
+                              warwick::PropertyList& output,
+                              std::size_t maxDepth = 4096);
+
+/// Parse input istream using document grammar in recovery mode.
+/// Properties that fail to parse are skipped up to the next top-level
+/// identifier and an error recorded, so output holds all the valid
+/// properties and errors every failure in the input. Returns true if
+/// there were no errors.
+bool parse_document(std::istream& input,
+                    warwick::PropertyList& output,
+                    warwick::ParseErrorList& errors);
+
+/// Parse input istream using document grammar in recovery mode, also
+/// collecting descriptions
+bool parse_document(std::istream& input,
+                    warwick::PropertyList& output,
+                    warwick::PropertyDescriptions& descriptions,
+                    warwick::ParseErrorList& errors);
+
+/// Parse input istream using document grammar in recovery mode, checking
+/// each property against schema as it is parsed. Schema violations are
+/// reported in errors alongside syntax errors, in document order.
+/// Returns true if the document is valid and conforms to the schema.
+bool parse_document(std::istream& input,
+                    warwick::PropertyList& output,
+                    const warwick::Schema& schema,
+                    warwick::ParseErrorList& errors);
+
 #endif // PROPERTYPARSER_HH
 
@@ -0,0 +1,35 @@
+// - PropertyPath.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyPath.hpp"
+
+namespace warwick {
+const Property* find_property(const PropertyList& document, const std::string& path) {
+  const PropertyList* list = &document;
+  std::string::size_type first(0);
+  for (;;) {
+    const std::string::size_type dot = path.find('.', first);
+    const std::string::size_type last = dot == std::string::npos ? path.size() : dot;
+
+    const Property* found(nullptr);
+    for (auto p = list->rbegin(); p != list->rend(); ++p) {
+      if (p->Key.size() == last - first && path.compare(first, last - first, p->Key) == 0) {
+        found = &*p;
+        break;
+      }
+    }
+    if (!found || dot == std::string::npos) return found;
+
+    list = boost::get<PropertyList>(&found->Value);
+    if (!list) return nullptr;
+    first = dot + 1;
+  }
+}
+} // namespace warwick
@@ -0,0 +1,29 @@
+// PropertyPath - look up properties in a document by dotted path
+//
+// Nested trees are addressed by joining keys with '.', e.g.
+// "geometry.layers.count", as used for descriptions and schemas.
+// If a tree holds a key more than once, the last one wins, as it would
+// when reading the document into a map.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYPATH_HH
+#define PROPERTYPATH_HH
+
+// Standard Library
+#include <string>
+
+// This Project
+#include "Property.hpp"
+
+namespace warwick {
+/// Return the property at path in document, or nullptr if there is none
+const Property* find_property(const PropertyList& document, const std::string& path);
+} // namespace warwick
+
+#endif // PROPERTYPATH_HH
@@ -0,0 +1,155 @@
+// - PropertyYAML.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "PropertyYAML.hpp"
+
+// Standard Library
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+// This Project
+#include "OutputBuffer.hpp"
+#include "PropertyJSON.hpp"
+
+namespace warwick {
+namespace {
+/// Identifiers can be written as plain scalars, except for those YAML
+/// would read as something other than a string
+bool plain_key(const std::string& key) {
+  if (key.empty() || !std::isalpha(static_cast<unsigned char>(key[0]))) return false;
+  for (char c : key) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+  }
+  static const char* const reserved[] = {"true", "false", "yes", "no", "on", "off",
+                                         "null", "y", "n"};
+  for (const char* r : reserved) {
+    if (key.size() == std::strlen(r) &&
+        std::equal(key.begin(), key.end(), r, [](char a, char b) {
+          return std::tolower(static_cast<unsigned char>(a)) == b;
+        })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class YAMLWriter : public boost::static_visitor<void> {
+ public:
+  YAMLWriter(OutputBuffer& out, std::size_t depth) : out_(out), depth_(depth) {}
+
+  void mapping(const PropertyList& list) {
+    for (const Property& p : list) {
+      out_.append(2 * depth_, ' ');
+      if (plain_key(p.Key)) {
+        out_.append(p.Key);
+      } else {
+        append_json_string(out_, p.Key);
+      }
+      out_.append(':');
+      boost::apply_visitor(*this, p.Value);
+      out_.maybe_flush();
+    }
+  }
+
+  void operator()(int value) const {
+    out_.append(' ');
+    out_.append_int(value);
+    out_.append('\n');
+  }
+
+  void operator()(double value) const {
+    out_.append(' ');
+    scalar(value);
+    out_.append('\n');
+  }
+
+  void operator()(bool value) const {
+    value ? out_.append(" true\n", 6) : out_.append(" false\n", 7);
+  }
+
+  void operator()(const std::string& value) const {
+    out_.append(' ');
+    append_json_string(out_, value);
+    out_.append('\n');
+  }
+
+  void operator()(const boost::dynamic_bitset<>& value) const {
+    out_.append(" !bitset \"", 10);
+    for (std::size_t i = value.size(); i > 0; --i) {
+      out_.append(value[i - 1] ? '1' : '0');
+    }
+    out_.append("\"\n", 2);
+  }
+
+  template <typename T>
+  void operator()(const std::vector<T>& value) const {
+    out_.append(" [", 2);
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (i) out_.append(", ", 2);
+      scalar(value[i]);
+      out_.maybe_flush();
+    }
+    out_.append("]\n", 2);
+  }
+
+  void operator()(const PropertyList& value) const {
+    if (value.empty()) {
+      out_.append(" {}\n", 4);
+      return;
+    }
+    out_.append('\n');
+    YAMLWriter(out_, depth_ + 1).mapping(value);
+  }
+
+ private:
+  void scalar(int value) const {
+    out_.append_int(value);
+  }
+
+  void scalar(double value) const {
+    if (std::isnan(value)) {
+      out_.append(".nan", 4);
+    } else if (std::isinf(value)) {
+      value < 0 ? out_.append("-.inf", 5) : out_.append(".inf", 4);
+    } else {
+      out_.append_real(value, true);
+    }
+  }
+
+  void scalar(const std::string& value) const {
+    append_json_string(out_, value);
+  }
+
+ private:
+  OutputBuffer& out_;
+  std::size_t depth_;
+};
+} // namespace
+
+void write_yaml(const PropertyList& document, std::string& buffer) {
+  OutputBuffer out(buffer);
+  if (document.empty()) {
+    out.append("{}\n", 3);
+    return;
+  }
+  YAMLWriter(out, 0).mapping(document);
+}
+
+void write_yaml(const PropertyList& document, std::ostream& os) {
+  OutputBuffer out(os);
+  if (document.empty()) {
+    out.append("{}\n", 3);
+    return;
+  }
+  YAMLWriter(out, 0).mapping(document);
+}
+} // namespace warwick
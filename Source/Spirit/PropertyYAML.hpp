@@ -0,0 +1,35 @@
+// PropertyYAML - stream PropertyLists out as YAML
+//
+// write_yaml writes block style YAML directly from a PropertyList,
+// without going through a YAML::Node tree. Trees become nested block
+// mappings (empty ones "{}"), arrays are written in flow style, strings
+// are always double quoted, reals always carry a decimal point or
+// exponent (non-finite ones as .nan/.inf), and bitsets are tagged
+// scalars, e.g. `mask: !bitset "0110"`.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PROPERTYYAML_HH
+#define PROPERTYYAML_HH
+
+// Standard Library
+#include <iosfwd>
+#include <string>
+
+// This Project
+#include "Property.hpp"
+
+namespace warwick {
+/// Append YAML text for document to buffer
+void write_yaml(const PropertyList& document, std::string& buffer);
+
+/// Write YAML text for document to os
+void write_yaml(const PropertyList& document, std::ostream& os);
+} // namespace warwick
+
+#endif // PROPERTYYAML_HH
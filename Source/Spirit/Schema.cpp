@@ -0,0 +1,246 @@
+// - Schema.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "Schema.hpp"
+
+// Standard Library
+#include <sstream>
+
+// This Project
+#include "PropertyParser.hpp"
+
+namespace warwick {
+namespace {
+const char* const cTypeNames[] = {"int", "real", "bool", "string", "bitset",
+                                  "int[]", "real[]", "string[]", "tree"};
+
+int type_index(const std::string& name) {
+  for (int i = kInt; i <= kTree; ++i) {
+    if (name == cTypeNames[i]) return i;
+  }
+  return -1;
+}
+
+bool get_number(const Property& p, double& value) {
+  if (const int* i = boost::get<int>(&p.Value)) {
+    value = *i;
+    return true;
+  }
+  if (const double* d = boost::get<double>(&p.Value)) {
+    value = *d;
+    return true;
+  }
+  return false;
+}
+
+bool get_bool(const Property& p, bool& value) {
+  const bool* b = boost::get<bool>(&p.Value);
+  if (b) value = *b;
+  return b != nullptr;
+}
+
+bool get_size(const Property& p, std::size_t& value) {
+  const int* i = boost::get<int>(&p.Value);
+  if (!i || *i < 0) return false;
+  value = static_cast<std::size_t>(*i);
+  return true;
+}
+
+/// Number of elements of arrays, or bits of bitsets
+struct SizeVisitor : public boost::static_visitor<std::size_t> {
+  template <typename T>
+  std::size_t operator()(const std::vector<T>& v) const {
+    return v.size();
+  }
+  std::size_t operator()(const boost::dynamic_bitset<>& v) const {
+    return v.size();
+  }
+  template <typename T>
+  std::size_t operator()(const T&) const {
+    return 0;
+  }
+};
+
+/// Check numeric values and array elements lie in [min, max]
+struct RangeVisitor : public boost::static_visitor<bool> {
+  RangeVisitor(const SchemaConstraint& c) : c_(c) {}
+
+  bool in_range(double x) const {
+    return !((c_.hasMin && x < c_.min) || (c_.hasMax && x > c_.max));
+  }
+  bool operator()(int v) const {
+    return in_range(v);
+  }
+  bool operator()(double v) const {
+    return in_range(v);
+  }
+  template <typename T>
+  bool operator()(const std::vector<T>& v) const {
+    for (const T& x : v) {
+      if (!(*this)(x)) return false;
+    }
+    return true;
+  }
+  template <typename T>
+  bool operator()(const T&) const {
+    return true;
+  }
+
+  const SchemaConstraint& c_;
+};
+} // namespace
+
+Schema::Schema() {
+  constraints_.push_back(SchemaConstraint{std::string(), cRoot, kTree, true, false,
+                                          false, false, 0.0, 0.0,
+                                          0, std::numeric_limits<std::size_t>::max()});
+  children_.resize(1);
+}
+
+bool Schema::compile(const PropertyList& definition, std::string& error) {
+  Schema compiled;
+  std::vector<PerfectHash<Key, index_type, KeyTraits>::entry_type> keys;
+  if (!compiled.add_fields(cRoot, definition, keys, error)) return false;
+  if (!compiled.table_.build(std::move(keys))) {
+    error = "duplicate property in schema";
+    return false;
+  }
+  *this = std::move(compiled);
+  return true;
+}
+
+bool Schema::read(std::istream& input, std::string& error) {
+  PropertyList definition;
+  ParseErrorList errors;
+  if (!parse_document(input, definition, errors)) {
+    std::ostringstream os;
+    os << errors.front().line << ":" << errors.front().column << ": "
+       << errors.front().message;
+    error = os.str();
+    return false;
+  }
+  return compile(definition, error);
+}
+
+bool Schema::add_fields(index_type parent,
+                        const PropertyList& fields,
+                        std::vector<PerfectHash<Key, index_type, KeyTraits>::entry_type>& keys,
+                        std::string& error) {
+  for (const Property& field : fields) {
+    const std::string path = parent == cRoot ? field.Key
+                                             : constraints_[parent].path + "." + field.Key;
+    const PropertyList* spec = boost::get<PropertyList>(&field.Value);
+    if (!spec) {
+      error = "schema for '" + path + "' must be a tree";
+      return false;
+    }
+
+    SchemaConstraint c{path, parent, -1, false, false, false, false, 0.0, 0.0,
+                       0, std::numeric_limits<std::size_t>::max()};
+    const PropertyList* children(nullptr);
+    for (const Property& p : *spec) {
+      bool ok = true;
+      if (p.Key == "type") {
+        const std::string* s = boost::get<std::string>(&p.Value);
+        ok = s && (c.which = type_index(*s)) >= 0;
+      } else if (p.Key == "required") {
+        ok = get_bool(p, c.required);
+      } else if (p.Key == "open") {
+        ok = get_bool(p, c.open);
+      } else if (p.Key == "min") {
+        ok = c.hasMin = get_number(p, c.min);
+      } else if (p.Key == "max") {
+        ok = c.hasMax = get_number(p, c.max);
+      } else if (p.Key == "size") {
+        ok = get_size(p, c.minSize);
+        c.maxSize = c.minSize;
+      } else if (p.Key == "minsize") {
+        ok = get_size(p, c.minSize);
+      } else if (p.Key == "maxsize") {
+        ok = get_size(p, c.maxSize);
+      } else if (p.Key == "fields") {
+        ok = (children = boost::get<PropertyList>(&p.Value)) != nullptr;
+      } else {
+        error = "unknown constraint '" + p.Key + "' for '" + path + "'";
+        return false;
+      }
+      if (!ok) {
+        error = "invalid constraint '" + p.Key + "' for '" + path + "'";
+        return false;
+      }
+    }
+
+    if (c.which < 0) {
+      error = "no type given for '" + path + "'";
+      return false;
+    }
+    const bool numeric = c.which == kInt || c.which == kReal ||
+                         c.which == kIntArray || c.which == kRealArray;
+    const bool sized = c.which == kBitset || (c.which >= kIntArray && c.which <= kStringArray);
+    const bool tree = c.which == kTree;
+    if ((c.hasMin || c.hasMax) && !numeric) {
+      error = "min/max given for non-numeric '" + path + "'";
+      return false;
+    }
+    if ((c.minSize > 0 || c.maxSize != std::numeric_limits<std::size_t>::max()) && !sized) {
+      error = "size given for '" + path + "', which is not an array or bitset";
+      return false;
+    }
+    if ((children || c.open) && !tree) {
+      error = "fields given for '" + path + "', which is not a tree";
+      return false;
+    }
+
+    const index_type index = static_cast<index_type>(constraints_.size());
+    constraints_.push_back(c);
+    children_.emplace_back();
+    children_[parent].push_back(index);
+    keys.emplace_back(Key{parent, field.Key}, index);
+    if (children && !add_fields(index, *children, keys, error)) return false;
+  }
+  return true;
+}
+
+bool Schema::check(index_type i, const Property::value_type& value, std::string& message) const {
+  const SchemaConstraint& c = constraints_[i];
+  if (value.which() != c.which) {
+    message = "must be of type " + std::string(cTypeNames[c.which]) + ", not " +
+              cTypeNames[value.which()];
+    return false;
+  }
+  if ((c.hasMin || c.hasMax) && !boost::apply_visitor(RangeVisitor(c), value)) {
+    std::ostringstream os;
+    os << "is outside the range [";
+    if (c.hasMin) os << c.min;
+    os << ", ";
+    if (c.hasMax) os << c.max;
+    os << "]";
+    message = os.str();
+    return false;
+  }
+  if (c.minSize > 0 || c.maxSize != std::numeric_limits<std::size_t>::max()) {
+    const std::size_t n = boost::apply_visitor(SizeVisitor(), value);
+    if (n < c.minSize || n > c.maxSize) {
+      std::ostringstream os;
+      os << "has size " << n << ", ";
+      if (c.minSize == c.maxSize) {
+        os << "expected " << c.minSize;
+      } else if (n < c.minSize) {
+        os << "expected at least " << c.minSize;
+      } else {
+        os << "expected at most " << c.maxSize;
+      }
+      message = os.str();
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace warwick
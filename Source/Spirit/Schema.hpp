@@ -0,0 +1,159 @@
+// Schema - compiled constraints on the properties of a document
+//
+// A schema is itself written in property syntax, with one tree per
+// property giving its constraints:
+//
+//   name : { type : string = "string"  required : bool = true }
+//   channels : { type : string = "int[]"  min : int = 0  size : int = 4 }
+//   geometry : {
+//     type : string = "tree"
+//     fields : {
+//       width : { type : string = "real"  min : real = 0  max : real = 10 }
+//     }
+//   }
+//
+// Constraint keys are
+//
+//   type     : one of int, real, bool, string, bitset, int[], real[],
+//              string[] or tree (required)
+//   required : property must be present (default false)
+//   min, max : inclusive bounds on int/real values or array elements
+//   size     : exact number of array elements or bitset bits
+//   minsize, maxsize : bounds on the number of elements or bits
+//   fields   : the schema of the properties in a tree
+//   open     : tree may hold properties not listed in fields
+//
+// Properties not listed in the schema are reported as unknown, unless
+// their enclosing tree is open.
+//
+// Compiling flattens the definition into a table of constraints, each
+// naming the tree it belongs to, which is indexed by a perfect hash on
+// (enclosing tree, key). Checking a property while parsing is then one
+// hash lookup and a few comparisons, see SchemaValidator in
+// PropertyGrammar.hpp.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SCHEMA_HH
+#define SCHEMA_HH
+
+// Standard Library
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Third Party
+// - Boost
+#include "boost/utility/string_ref.hpp"
+
+// This Project
+#include "PerfectHash.hpp"
+#include "Property.hpp"
+
+namespace warwick {
+/// Constraints on a single property
+struct SchemaConstraint {
+  std::string path;        ///< Dotted path of the property
+  std::uint32_t parent;    ///< Index of the enclosing tree constraint
+  int which;               ///< Required Property::value_type::which()
+  bool required;
+  bool open;
+  bool hasMin;
+  bool hasMax;
+  double min;
+  double max;
+  std::size_t minSize;
+  std::size_t maxSize;
+};
+
+class Schema {
+ public:
+  typedef std::uint32_t index_type;
+
+  /// Index of the implicit root tree
+  static const index_type cRoot = 0;
+  /// Index returned for keys not in the schema
+  static const index_type cNone = std::numeric_limits<index_type>::max();
+
+ public:
+  /// Construct an empty schema, which accepts only empty documents
+  Schema();
+
+  /// Compile the schema definition, returning false and describing the
+  /// problem in error if it is not a valid schema
+  bool compile(const PropertyList& definition, std::string& error);
+
+  /// Parse and compile a schema definition from input
+  bool read(std::istream& input, std::string& error);
+
+  /// Return index of the constraint for key in tree parent, or cNone
+  index_type find(index_type parent, boost::string_ref key) const {
+    const index_type* i = table_.find(KeyRef{parent, key});
+    return i ? *i : cNone;
+  }
+
+  const SchemaConstraint& constraint(index_type i) const {
+    return constraints_[i];
+  }
+
+  /// Indices of the properties listed for tree i
+  const std::vector<index_type>& children(index_type i) const {
+    return children_[i];
+  }
+
+  /// Number of constraints, including the root
+  std::size_t size() const {
+    return constraints_.size();
+  }
+
+  /// Check value against constraint i, returning false and describing
+  /// the violation in message if it fails
+  bool check(index_type i, const Property::value_type& value, std::string& message) const;
+
+ private:
+  struct Key {
+    index_type parent;
+    std::string name;
+  };
+
+  struct KeyRef {
+    index_type parent;
+    boost::string_ref name;
+  };
+
+  struct KeyTraits {
+    static std::uint64_t hash(const Key& k) {
+      return hash(KeyRef{k.parent, k.name});
+    }
+    static std::uint64_t hash(const KeyRef& k) {
+      return fnv1a(k.name.data(), k.name.size()) ^ (k.parent * 0xc2b2ae3d27d4eb4fULL);
+    }
+    static bool equal(const Key& stored, const KeyRef& k) {
+      return stored.parent == k.parent && boost::string_ref(stored.name) == k.name;
+    }
+    static bool equal(const Key& stored, const Key& k) {
+      return equal(stored, KeyRef{k.parent, k.name});
+    }
+  };
+
+  bool add_fields(index_type parent,
+                  const PropertyList& fields,
+                  std::vector<PerfectHash<Key, index_type, KeyTraits>::entry_type>& keys,
+                  std::string& error);
+
+ private:
+  std::vector<SchemaConstraint> constraints_;
+  std::vector<std::vector<index_type> > children_;
+  PerfectHash<Key, index_type, KeyTraits> table_;
+};
+} // namespace warwick
+
+#endif // SCHEMA_HH
@@ -0,0 +1,112 @@
+// - SharedProperty.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "SharedProperty.hpp"
+
+// Standard Library
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace warwick {
+namespace {
+/// Size of the magic number at the start of the flat header
+const std::size_t cMagicSize = 8;
+}
+
+bool publish_shared(const std::string& name, const PropertyList& document, std::string& error) {
+  std::string buffer;
+  if (!flatten(document, buffer)) {
+    error = "document is too large to flatten";
+    return false;
+  }
+
+  ::shm_unlink(name.c_str());
+  const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    error = "shm_open: " + std::string(std::strerror(errno));
+    return false;
+  }
+  if (::ftruncate(fd, static_cast<off_t>(buffer.size())) < 0) {
+    error = "ftruncate: " + std::string(std::strerror(errno));
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    return false;
+  }
+  void* data = ::mmap(nullptr, buffer.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    error = "mmap: " + std::string(std::strerror(errno));
+    ::shm_unlink(name.c_str());
+    return false;
+  }
+
+  // Body first, then the magic number that marks the segment complete
+  char* target = static_cast<char*>(data);
+  std::memcpy(target + cMagicSize, buffer.data() + cMagicSize, buffer.size() - cMagicSize);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(target, buffer.data(), cMagicSize);
+  ::munmap(data, buffer.size());
+  return true;
+}
+
+bool unpublish_shared(const std::string& name) {
+  return ::shm_unlink(name.c_str()) == 0;
+}
+
+SharedPropertyMap::~SharedPropertyMap() {
+  close();
+}
+
+bool SharedPropertyMap::open(const std::string& name, std::string& error) {
+  close();
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    error = "shm_open: " + std::string(std::strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) < 0 || st.st_size <= 0) {
+    error = "segment is empty";
+    ::close(fd);
+    return false;
+  }
+  const std::size_t size = static_cast<std::size_t>(st.st_size);
+  void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    error = "mmap: " + std::string(std::strerror(errno));
+    return false;
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!open_flat(data, size, root_)) {
+    error = "segment does not hold a complete flat document";
+    ::munmap(data, size);
+    return false;
+  }
+  data_ = data;
+  size_ = size;
+  return true;
+}
+
+void SharedPropertyMap::close() {
+  if (data_) ::munmap(data_, size_);
+  data_ = nullptr;
+  size_ = 0;
+  root_ = FlatList();
+}
+} // namespace warwick
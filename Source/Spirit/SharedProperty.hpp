@@ -0,0 +1,71 @@
+// SharedProperty - publish flat PropertyLists in POSIX shared memory
+//
+// One process parses a document and publishes it, in the flat layout of
+// FlatProperty.hpp, as a named shared memory segment. Any number of
+// reader processes then map the segment read-only and query it in place,
+// so a node holds a single copy however many processes use it.
+//
+// The header's magic number is written last, so readers never see a
+// partially written segment. Republishing unlinks the old segment and
+// creates a new one: readers that already mapped the old one keep it
+// until they unmap it, while a reader opening during the switch simply
+// fails to open and may retry.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SHAREDPROPERTY_HH
+#define SHAREDPROPERTY_HH
+
+// Standard Library
+#include <cstddef>
+#include <string>
+
+// This Project
+#include "FlatProperty.hpp"
+
+namespace warwick {
+/// Publish document as the shared memory segment name (which should
+/// start with '/'), replacing any previous segment of that name.
+/// Returns false and describes the problem in error on failure.
+bool publish_shared(const std::string& name, const PropertyList& document, std::string& error);
+
+/// Remove the segment name. Existing mappings remain valid.
+bool unpublish_shared(const std::string& name);
+
+/// Read-only mapping of a published segment
+class SharedPropertyMap {
+ public:
+  SharedPropertyMap() : data_(nullptr), size_(0) {}
+  ~SharedPropertyMap();
+
+  SharedPropertyMap(const SharedPropertyMap&) = delete;
+  SharedPropertyMap& operator=(const SharedPropertyMap&) = delete;
+
+  /// Map the segment name, returning false and describing the problem
+  /// in error if it does not exist or does not hold a flat document
+  bool open(const std::string& name, std::string& error);
+
+  void close();
+
+  /// The top level properties of the mapped document
+  const FlatList& root() const {
+    return root_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+ private:
+  void* data_;
+  std::size_t size_;
+  FlatList root_;
+};
+} // namespace warwick
+
+#endif // SHAREDPROPERTY_HH
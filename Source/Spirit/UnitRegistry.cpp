@@ -0,0 +1,151 @@
+// - UnitRegistry.cpp - Implementation
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Ourselves
+#include "UnitRegistry.hpp"
+
+// Standard Library
+#include <cmath>
+#include <limits>
+#include <set>
+
+// This Project
+#include "BulkConversion.hpp"
+
+namespace warwick {
+const UnitRegistry::unit_id UnitRegistry::cUnknownUnit;
+const double UnitRegistry::cNoFactor = std::numeric_limits<double>::quiet_NaN();
+
+UnitRegistry::UnitRegistry() {
+  for (const units::detail::UnitSymbol& u : units::cUnitIndex.symbols) {
+    char text[16] = {};
+    units::detail::symbol_text(u, text);
+    const std::string symbol(text);
+    units_.push_back(Definition(symbol, units::find_unit(symbol.data(), symbol.size())));
+  }
+  build();
+}
+
+bool UnitRegistry::define(const std::vector<Definition>& units) {
+  std::set<std::string> names;
+  for (const Definition& d : units) {
+    // Factors are divided by each other, so must be finite and positive
+    const double f = d.second.factor;
+    if (!units::is_valid(d.second.dimension) || !std::isfinite(f) || f <= 0.0 ||
+        find(d.first) != cUnknownUnit || !names.insert(d.first).second) {
+      return false;
+    }
+  }
+  units_.insert(units_.end(), units.begin(), units.end());
+  if (!build()) {
+    // A new name has the hash of another, so go back to the units before
+    units_.resize(units_.size() - units.size());
+    build();
+    return false;
+  }
+  return true;
+}
+
+bool UnitRegistry::build() {
+  std::vector<PerfectHash<std::string, unit_id>::entry_type> entries;
+  members_.assign(units_.size(), Member());
+  groups_.clear();
+  for (std::size_t i = 0; i < units_.size(); ++i) {
+    entries.emplace_back(units_[i].first, static_cast<unit_id>(i));
+
+    // Few dimensions, so a linear search for the group is fine
+    const units::dimension_code d = units_[i].second.dimension;
+    std::size_t g = 0;
+    while (g < groups_.size() && groups_[g].dimension != d) ++g;
+    if (g == groups_.size()) groups_.push_back(Group{d, 0, std::vector<double>()});
+    members_[i] = Member{static_cast<std::uint32_t>(g),
+                         static_cast<std::uint32_t>(groups_[g].size++)};
+  }
+  if (!index_.build(entries)) return false;
+
+  std::vector<std::vector<double> > scales(groups_.size());
+  for (std::size_t i = 0; i < units_.size(); ++i) {
+    scales[members_[i].group].push_back(units_[i].second.factor);
+  }
+  for (std::size_t g = 0; g < groups_.size(); ++g) {
+    const std::vector<double>& s = scales[g];
+    std::vector<double>& f = groups_[g].factors;
+    f.resize(s.size() * s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) {
+      for (std::size_t j = 0; j < s.size(); ++j) f[i * s.size() + j] = s[i] / s[j];
+    }
+  }
+  return true;
+}
+
+bool UnitRegistry::convert(const double* in,
+                           std::size_t n,
+                           unit_id from,
+                           unit_id to,
+                           double* out) const {
+  const double f = factor(from, to);
+  if (std::isnan(f)) return false;
+  units::convert(in, out, n, units::Conversion{f, 0.0});
+  return true;
+}
+
+std::size_t UnitRegistry::convert(const double* in,
+                                  const unit_id* units,
+                                  std::size_t n,
+                                  unit_id to,
+                                  double* out) const {
+  std::size_t failed(0);
+  for (std::size_t i = 0; i < n; ++i) {
+    const double f = units[i] < units_.size() ? factor(units[i], to) : cNoFactor;
+    failed += std::isnan(f);
+    out[i] = in[i] * f;
+  }
+  return failed;
+}
+
+template <typename Name>
+std::size_t UnitRegistry::convert_named(const double* in,
+                                        const Name* units,
+                                        std::size_t n,
+                                        unit_id to,
+                                        double* out) const {
+  // Records usually come in runs of the same unit, so only look up a
+  // name when it changes
+  std::size_t failed(0);
+  boost::string_ref last;
+  double f = cNoFactor;
+  for (std::size_t i = 0; i < n; ++i) {
+    const boost::string_ref name(units[i]);
+    if (i == 0 || name != last) {
+      const unit_id id = find(name);
+      f = id == cUnknownUnit ? cNoFactor : factor(id, to);
+      last = name;
+    }
+    failed += std::isnan(f);
+    out[i] = in[i] * f;
+  }
+  return failed;
+}
+
+std::size_t UnitRegistry::convert(const double* in,
+                                  const boost::string_ref* units,
+                                  std::size_t n,
+                                  unit_id to,
+                                  double* out) const {
+  return convert_named(in, units, n, to, out);
+}
+
+std::size_t UnitRegistry::convert(const double* in,
+                                  const std::string* units,
+                                  std::size_t n,
+                                  unit_id to,
+                                  double* out) const {
+  return convert_named(in, units, n, to, out);
+}
+} // namespace warwick
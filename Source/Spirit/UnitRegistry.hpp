@@ -0,0 +1,151 @@
+// UnitRegistry - runtime lookup and conversion of named units
+//
+// Conversion services read records of "value unit" and want them in some
+// other unit. The registry holds every symbol of the unit table (SI and
+// HEP units, with prefixes) plus any units defined at runtime, of any
+// dimension, indexed by a perfect hash so a name costs one hash and one
+// comparison to resolve to a unit_id.
+//
+// Units are grouped by dimension, and each group keeps the conversion
+// factor between every pair of its units, so converting a value is one
+// lookup and one multiply. Batch conversions take whole columns of
+// values, with a single unit or one per value, in one call.
+//
+// A registry is not modified by lookups or conversions, so may be shared
+// between threads once defined.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef UNITREGISTRY_HH
+#define UNITREGISTRY_HH
+
+// Standard Library
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Third Party
+// - Boost
+#include "boost/utility/string_ref.hpp"
+
+// This Project
+#include "PerfectHash.hpp"
+#include "UnitTable.hpp"
+
+namespace warwick {
+class UnitRegistry {
+ public:
+  typedef std::uint32_t unit_id;
+  typedef std::pair<std::string, units::UnitValue> Definition;
+
+  static const unit_id cUnknownUnit = 0xffffffff;
+
+ public:
+  /// Registry of every symbol in the unit table
+  UnitRegistry();
+
+  /// Add units, e.g. {"foot", {0.3048, length}}, returning false and
+  /// leaving the registry unchanged if any name is already known or
+  /// any value has an invalid dimension, or a factor that is not finite
+  /// and positive. Names are hashed to 64 bits, and one that shares the
+  /// hash of another known name is also rejected
+  bool define(const std::vector<Definition>& units);
+
+  /// Number of units
+  std::size_t size() const {
+    return units_.size();
+  }
+
+  /// Id of the unit called name, or cUnknownUnit
+  unit_id find(boost::string_ref name) const {
+    const unit_id* id = index_.find(name);
+    return id ? *id : cUnknownUnit;
+  }
+
+  const std::string& name(unit_id id) const {
+    return units_[id].first;
+  }
+
+  const units::UnitValue& value(unit_id id) const {
+    return units_[id].second;
+  }
+
+  /// Factor converting values in from to values in to, or NaN if their
+  /// dimensions differ. Here and below, ids must be valid
+  double factor(unit_id from, unit_id to) const {
+    const Member& f = members_[from];
+    const Member& t = members_[to];
+    if (f.group != t.group) return cNoFactor;
+    const Group& g = groups_[f.group];
+    return g.factors[f.index * g.size + t.index];
+  }
+
+  /// Convert n values in unit from to unit to, returning false if their
+  /// dimensions differ
+  bool convert(const double* in, std::size_t n, unit_id from, unit_id to, double* out) const;
+
+  /// Convert n values, the i'th in units[i], to unit to. Values whose
+  /// unit is unknown (cUnknownUnit, or a name not found) or of the wrong
+  /// dimension are set to NaN, and the number of these is returned.
+  std::size_t convert(const double* in,
+                      const unit_id* units,
+                      std::size_t n,
+                      unit_id to,
+                      double* out) const;
+
+  /// As above, with units given by name
+  std::size_t convert(const double* in,
+                      const boost::string_ref* units,
+                      std::size_t n,
+                      unit_id to,
+                      double* out) const;
+
+  std::size_t convert(const double* in,
+                      const std::string* units,
+                      std::size_t n,
+                      unit_id to,
+                      double* out) const;
+
+ private:
+  struct Member {
+    std::uint32_t group;
+    std::uint32_t index;
+  };
+
+  /// Units of one dimension, with factors[i * size + j] from the i'th
+  /// to the j'th
+  struct Group {
+    units::dimension_code dimension;
+    std::size_t size;
+    std::vector<double> factors;
+  };
+
+  static const double cNoFactor;
+
+  template <typename Name>
+  std::size_t convert_named(const double* in,
+                            const Name* units,
+                            std::size_t n,
+                            unit_id to,
+                            double* out) const;
+
+  /// Rebuild groups and index from units_, returning false if two names
+  /// share a hash
+  bool build();
+
+ private:
+  std::vector<Definition> units_;
+  std::vector<Member> members_;
+  std::vector<Group> groups_;
+  PerfectHash<std::string, unit_id> index_;
+};
+} // namespace warwick
+
+#endif // UNITREGISTRY_HH
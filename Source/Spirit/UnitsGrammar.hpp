@@ -38,6 +38,11 @@
 // - Only checks that the input is sane, not that it meets a dimensional
 //   requirement
 //
+// get_unit_value now also synthesises the dimension, packed as in
+// Units/UnitDimension.hpp, and overloads taking a required dimension
+// reject expressions of any other, so a declared dimension is checked
+// in the same pass that finds the factor.
+//
 // In last case, can probably build up parsers for specific types using a
 // grammar class templated on symbol types and exponents - pseudo:
 //
@@ -50,61 +55,64 @@
 //
 // NB - should "collapse" to "unit_grammar<length_, 1, time, -2>", but that'll
 // be more complex.
+//
+// Unit expressions known at compile time are handled by the constexpr
+// parser in Units/UnitLiteral.hpp, which yields the boost::units type.
 
 
 #ifndef UNITSGRAMMAR_HH
 #define UNITSGRAMMAR_HH
 
 #include <boost/spirit/include/qi.hpp>
+#include <boost/spirit/include/phoenix.hpp>
 // Needed to use pairs in qi grammars/as attributes
 #include <boost/fusion/include/std_pair.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
 
-#include <numeric>
+#include "UnitCache.hpp"
+#include "UnitTable.hpp"
 
 
 namespace BoostExamples {
 namespace bsqi = boost::spirit::qi;
 
-// Symbol tables for converting length, mass and time
-// Could also be constructed on fly by custom function (e.g. use CLHEP
-// to get conversion factors)
-struct length_ : bsqi::symbols<char,double> {
-  length_() {
-    add
-        ("m", 2.0)
-        ;
+// Unit symbols come from the constexpr table in Units/UnitTable.hpp,
+// which covers the SI units with all prefixes plus common HEP units.
+// A symbol is read as one token (anything up to whitespace or '^') and
+// looked up by hash, so no symbol trie is built at startup.
+struct find_unit_impl {
+  typedef bool result_type;
+
+  template <typename Range>
+  bool operator()(const Range& symbol, warwick::units::UnitValue& value) const {
+    value = warwick::units::find_unit(&*symbol.begin(), symbol.size());
+    return warwick::units::is_valid(value.dimension);
   }
-} lengths;
+};
 
-struct mass_ : bsqi::symbols<char,double> {
-  mass_() {
-    add
-        ("kg", 1.0)
-        ;
-  }
-} masses;
+const boost::phoenix::function<find_unit_impl> find_unit_value;
 
-struct time_ : bsqi::symbols<char,double> {
-  time_() {
-    add
-        ("s", 3.0)
-        ;
-  }
-} times;
-
-
-// Implement as simpele parse (no skipping) for now
+// Parse without consulting the cache
 template <typename Iterator>
-bool get_unit_factor(Iterator first, Iterator last, double& factor) {
+bool parse_unit_value(Iterator first, Iterator last, warwick::units::UnitValue& value) {
   // The object the grammar should synthesize down to
-  std::vector<std::pair<double,int> > attr;
+  std::vector<std::pair<warwick::units::UnitValue,int> > attr;
+
+  // A rule without a skipper, so the symbol is a lexeme
+  bsqi::rule<Iterator, warwick::units::UnitValue()> symbol =
+      bsqi::raw[+(bsqi::char_ - bsqi::space - bsqi::lit('^'))]
+               [bsqi::_pass = find_unit_value(bsqi::_1, bsqi::_val)];
 
   bool r = bsqi::phrase_parse(first, last,
     // Grammar def
     (
         // Need to non-skip inside because ws is the separator between elements
         bsqi::lexeme[
-          ( (lengths | masses | times)
+          ( symbol
            >>
            ((bsqi::lit('^') > bsqi::int_) | bsqi::attr(1)) )
           % bsqi::space
@@ -122,15 +130,84 @@ bool get_unit_factor(Iterator first, Iterator last, double& factor) {
   // Ideally want grammar to do this for us - a semantic
   // action is probably easiest given the simplicity of the grammar,
   // but could also consider transform_attribute.
-  factor = std::accumulate(attr.begin(), attr.end(),
-                           1.0,
-                           [](double current, auto& in) {
-                             return current*std::pow(in.first, in.second);
-                           });
+  value = warwick::units::UnitValue{1.0, warwick::units::cDimensionless};
+  for (const auto& in : attr) {
+    value.factor *= std::pow(in.first.factor, in.second);
+    value.dimension = warwick::units::multiply(value.dimension,
+                                               warwick::units::power(in.first.dimension, in.second));
+  }
+  return warwick::units::is_valid(value.dimension);
+}
+
+// Text of [first, last) as a string_ref, without copying when the
+// characters are contiguous. Other iterators are copied into storage
+inline boost::string_ref unit_text(const char* first, const char* last, std::string&) {
+  return boost::string_ref(first, static_cast<std::size_t>(last - first));
+}
+
+inline boost::string_ref unit_text(std::string::const_iterator first,
+                                   std::string::const_iterator last,
+                                   std::string&) {
+  if (first == last) return boost::string_ref();
+  return boost::string_ref(&*first, static_cast<std::size_t>(last - first));
+}
+
+inline boost::string_ref unit_text(std::string::iterator first,
+                                   std::string::iterator last,
+                                   std::string&) {
+  if (first == last) return boost::string_ref();
+  return boost::string_ref(&*first, static_cast<std::size_t>(last - first));
+}
 
-  return r;
+template <typename Iterator>
+boost::string_ref unit_text(Iterator first, Iterator last, std::string& storage) {
+  storage.assign(first, last);
+  return boost::string_ref(storage);
+}
+
+// Factor and dimension of the unit expression [first, last). Expressions
+// are memoised in warwick::units::unit_cache(), so repeating one costs a
+// single hash lookup and no allocation.
+template <typename Iterator>
+bool get_unit_value(Iterator first, Iterator last, warwick::units::UnitValue& value) {
+  std::string storage;
+  const boost::string_ref expression = unit_text(first, last, storage);
+  warwick::units::UnitCache& cache = warwick::units::unit_cache();
+  if (cache.find(expression, value)) return true;
+  if (!parse_unit_value(expression.begin(), expression.end(), value)) return false;
+  cache.insert(expression, value);
+  return true;
+}
+
+// Implement as simpele parse (no skipping) for now
+template <typename Iterator>
+bool get_unit_factor(Iterator first, Iterator last, double& factor) {
+  warwick::units::UnitValue value;
+  if (!get_unit_value(first, last, value)) return false;
+  factor = value.factor;
+  return true;
+}
+
+// As get_unit_value, but also failing unless the expression has the
+// required dimension, e.g. warwick::units::find_dimension("length", 6)
+template <typename Iterator>
+bool get_unit_value(Iterator first, Iterator last,
+                    warwick::units::dimension_code required,
+                    warwick::units::UnitValue& value) {
+  return get_unit_value(first, last, value) && value.dimension == required;
+}
+
+// As get_unit_factor, but also failing unless the expression has the
+// required dimension
+template <typename Iterator>
+bool get_unit_factor(Iterator first, Iterator last,
+                     warwick::units::dimension_code required,
+                     double& factor) {
+  warwick::units::UnitValue value;
+  if (!get_unit_value(first, last, required, value)) return false;
+  factor = value.factor;
+  return true;
 }
 
 } // namespace BoostExamples
 #endif // UNITSGRAMMAR_HH
-
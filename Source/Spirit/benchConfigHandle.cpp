@@ -0,0 +1,118 @@
+// benchConfigHandle - lookup throughput while the configuration reloads
+//
+// Reader threads look up a property by path as fast as they can for a
+// fixed time, while another thread reloads the document from disk in a
+// loop. Readers either take a fresh snapshot for every lookup, or hold a
+// ConfigHandle::Reader that only reloads its snapshot after a publish.
+// Each variant is also run without the reloader for comparison.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Standard Library
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX
+#include <unistd.h>
+
+// This Project
+#include "ConfigHandle.hpp"
+#include "PropertyPath.hpp"
+
+namespace {
+const std::chrono::milliseconds cDuration(500);
+
+template <typename Lookup>
+void run(const char* name, warwick::ConfigHandle& handle, const std::string& file,
+         bool reloading, Lookup lookup) {
+  const unsigned threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+  std::atomic<bool> done(false);
+  std::atomic<unsigned long long> lookups(0);
+  unsigned long long reloads(0);
+
+  std::vector<std::thread> readers;
+  for (unsigned t = 0; t < threads; ++t) {
+    readers.emplace_back([&]() {
+      unsigned long long n(0);
+      unsigned long long found(0);
+      lookup(done, n, found);
+      if (found != n) std::cerr << name << ": lookup failed" << std::endl;
+      lookups += n;
+    });
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < cDuration) {
+    if (reloading) {
+      warwick::ParseErrorList errors;
+      if (!handle.reload(file, errors)) std::cerr << name << ": reload failed" << std::endl;
+      ++reloads;
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  done = true;
+  for (auto& t : readers) t.join();
+
+  const double seconds = std::chrono::duration<double>(cDuration).count();
+  std::cout << "  " << name << (reloading ? " (reloading)" : "") << " : "
+            << lookups / seconds / 1e6 << " M lookups/s over " << threads << " threads, "
+            << reloads << " reloads" << std::endl;
+}
+}
+
+int main() {
+  const std::string file = "/tmp/benchConfigHandle." + std::to_string(::getpid()) + ".conf";
+  {
+    std::ofstream out(file);
+    for (int i = 0; i < 200; ++i) {
+      out << "block" << i << " : {\n"
+          << "  id : int = " << i << "\n"
+          << "  weights : real = [0.5, 1.5, 2.5]\n"
+          << "}\n";
+    }
+  }
+
+  warwick::ConfigHandle handle;
+  warwick::ParseErrorList errors;
+  if (!handle.reload(file, errors)) {
+    std::cerr << "cannot parse " << file << std::endl;
+    return 1;
+  }
+
+  auto snapshot = [&](std::atomic<bool>& done, unsigned long long& n,
+                      unsigned long long& found) {
+    for (; !done.load(std::memory_order_relaxed); ++n) {
+      warwick::ConfigHandle::Snapshot doc = handle.snapshot();
+      found += warwick::find_property(*doc, "block7.id") != nullptr;
+    }
+  };
+  auto reader = [&](std::atomic<bool>& done, unsigned long long& n,
+                    unsigned long long& found) {
+    warwick::ConfigHandle::Reader config(handle);
+    for (; !done.load(std::memory_order_relaxed); ++n) {
+      found += warwick::find_property(config.get(), "block7.id") != nullptr;
+    }
+  };
+
+  std::cout << "Lookup throughput:" << std::endl;
+  for (bool reloading : {false, true}) {
+    run("snapshot per lookup", handle, file, reloading, snapshot);
+    run("cached reader", handle, file, reloading, reader);
+  }
+
+  std::remove(file.c_str());
+  return 0;
+}
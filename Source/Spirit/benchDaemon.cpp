@@ -0,0 +1,104 @@
+// benchDaemon - request latency of the daemon against in-process parsing
+//
+// Times, per request, parsing a mid-sized document in-process with
+// parse_document, and asking an in-process PropertyDaemon to parse or
+// query it over its Unix socket, either reusing one connection or
+// connecting for every request as a short-lived tool would.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Standard Library
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX
+#include <unistd.h>
+
+// This Project
+#include "PropertyClient.hpp"
+#include "PropertyDaemon.hpp"
+#include "PropertyParser.hpp"
+
+namespace {
+const std::size_t cRequests = 2000;
+
+template <typename F>
+void report(const char* name, F request) {
+  std::vector<double> us(cRequests);
+  for (std::size_t i = 0; i < cRequests; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    if (!request()) {
+      std::cerr << name << ": request failed" << std::endl;
+      return;
+    }
+    us[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                .count();
+  }
+  std::sort(us.begin(), us.end());
+  double total(0.0);
+  for (double t : us) total += t;
+  std::cout << "  " << name << " : mean " << total / cRequests << " us, p50 "
+            << us[cRequests / 2] << " us, p99 " << us[cRequests * 99 / 100] << " us"
+            << std::endl;
+}
+}
+
+int main() {
+  const std::string prefix = "/tmp/benchDaemon." + std::to_string(::getpid());
+  const std::string file = prefix + ".conf";
+  const std::string socket = prefix + ".sock";
+  {
+    std::ofstream out(file);
+    for (int i = 0; i < 200; ++i) {
+      out << "block" << i << " : {\n"
+          << "  id : int = " << i << "\n"
+          << "  weights : real = [0.5, 1.5, 2.5]\n"
+          << "  label : string = \"block " << i << "\"\n"
+          << "}\n";
+    }
+  }
+
+  warwick::PropertyDaemon daemon;
+  std::string error;
+  if (!daemon.listen(socket, error)) {
+    std::cerr << "cannot listen: " << error << std::endl;
+    return 1;
+  }
+  std::thread server(&warwick::PropertyDaemon::serve, &daemon);
+
+  report("in-process parse   ", [&file]() {
+    std::ifstream input(file);
+    input.unsetf(std::ios::skipws);
+    warwick::PropertyList doc;
+    warwick::ParseErrorList errors;
+    return parse_document(input, doc, errors);
+  });
+
+  warwick::PropertyClient client;
+  client.connect(socket);
+  warwick::PropertyClient::Response r;
+  report("daemon PARSE       ", [&]() { return client.parse(file, r) && r.ok; });
+  report("daemon QUERY       ", [&]() { return client.query(file, "block150.id", r) && r.ok; });
+  report("connect + PARSE    ", [&]() {
+    warwick::PropertyClient once;
+    return once.connect(socket) && once.parse(file, r) && r.ok;
+  });
+
+  client.close();
+  daemon.stop();
+  server.join();
+  std::remove(file.c_str());
+  return 0;
+}
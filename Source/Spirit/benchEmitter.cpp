@@ -0,0 +1,76 @@
+// benchEmitter - throughput of the canonical emitter
+//
+// Builds a large PropertyList of mixed scalars, arrays and trees, then
+// compares writing it out with emit_document against the debugging
+// ostream operators from Property.hpp, reporting MB/s for each.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Standard Library
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// This Project
+#include "PropertyEmitter.hpp"
+
+namespace {
+const std::size_t cBlocks = 20000;
+
+warwick::PropertyList make_document() {
+  using warwick::Property;
+  warwick::PropertyList doc;
+  for (std::size_t i = 0; i < cBlocks; ++i) {
+    warwick::PropertyList tree;
+    tree.push_back(Property{"count", static_cast<int>(i)});
+    tree.push_back(Property{"weight", 1.0 / static_cast<double>(i + 3)});
+    tree.push_back(Property{"name", std::string("block")});
+    tree.push_back(Property{"enabled", (i % 2) == 0});
+    tree.push_back(Property{"mask", boost::dynamic_bitset<>(16, i)});
+    tree.push_back(Property{"bins", std::vector<double>{0.1 * i, 0.25, 3.0e-7, 12345.678}});
+    tree.push_back(Property{"ids", std::vector<int>{1, -2, 3000, static_cast<int>(i)}});
+    doc.push_back(Property{"block" + std::to_string(i), tree});
+  }
+  return doc;
+}
+
+template <typename F>
+void report(const char* name, F writer) {
+  auto start = std::chrono::steady_clock::now();
+  std::size_t bytes = writer();
+  auto stop = std::chrono::steady_clock::now();
+  double s = std::chrono::duration<double>(stop - start).count();
+  std::cout << "  " << name << " : " << bytes / 1024 << " kB in " << s * 1e3
+            << " ms (" << bytes / s / 1e6 << " MB/s)" << std::endl;
+}
+}
+
+int main() {
+  const warwick::PropertyList doc = make_document();
+
+  report("emit_document (string) ", [&doc]() {
+    std::string text;
+    warwick::emit_document(doc, text);
+    return text.size();
+  });
+
+  report("emit_document (ostream)", [&doc]() {
+    std::ostringstream os;
+    warwick::emit_document(doc, os);
+    return os.str().size();
+  });
+
+  report("operator<<             ", [&doc]() {
+    std::ostringstream os;
+    for (const warwick::Property& p : doc) os << p << "\n";
+    return os.str().size();
+  });
+  return 0;
+}
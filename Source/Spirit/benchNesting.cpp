@@ -0,0 +1,82 @@
+// benchNesting - compare recursive and iterative parsing of nested trees
+//
+// Parses documents holding the same number of leaf properties spread
+// over trees nested to increasing depth, using the recursive grammar
+// (parse_document) and the explicit stack parser
+// (parse_document_iterative). The recursive grammar is only run up to a
+// modest depth, as beyond that it exhausts the stack.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Standard Library
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// This Project
+#include "PropertyParser.hpp"
+
+namespace {
+const std::size_t cLeaves = 20000;
+const std::size_t cMaxRecursiveDepth = 100;
+
+/// Document of cLeaves properties, with a chain of depth trees wrapping
+/// each block of leaves
+std::string make_document(std::size_t depth) {
+  std::ostringstream os;
+  const std::size_t perBlock = 100;
+  for (std::size_t block = 0; block < cLeaves / perBlock; ++block) {
+    for (std::size_t d = 0; d < depth; ++d) {
+      os << "level" << d << " : {\n";
+    }
+    for (std::size_t i = 0; i < perBlock; ++i) {
+      os << "leaf" << i << " : real = " << i << ".5\n";
+    }
+    os << std::string(depth, '}') << "\n";
+  }
+  return os.str();
+}
+
+template <typename F>
+double time_ms(const std::string& text, F parser) {
+  auto start = std::chrono::steady_clock::now();
+  std::istringstream input(text);
+  warwick::PropertyList doc;
+  if (!parser(input, doc)) {
+    std::cerr << "parse failed" << std::endl;
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+}
+
+int main() {
+  const std::size_t depths[] = {0, 1, 10, 100, 1000, 4000};
+
+  for (std::size_t depth : depths) {
+    const std::string text = make_document(depth);
+    std::cout << "depth " << depth << " (" << text.size() / 1024 << " kB)" << std::endl;
+
+    if (depth <= cMaxRecursiveDepth) {
+      double t = time_ms(text, [](std::istream& in, warwick::PropertyList& doc) {
+        return parse_document(in, doc);
+      });
+      std::cout << "  recursive : " << t << " ms" << std::endl;
+    } else {
+      std::cout << "  recursive : skipped" << std::endl;
+    }
+
+    double t = time_ms(text, [depth](std::istream& in, warwick::PropertyList& doc) {
+      return parse_document_iterative(in, doc, depth + 1);
+    });
+    std::cout << "  iterative : " << t << " ms" << std::endl;
+  }
+  return 0;
+}
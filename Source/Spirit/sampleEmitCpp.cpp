@@ -0,0 +1,42 @@
+// sampleEmitCpp - use a document compiled by PropertyChecker --emit-cpp
+//
+// The header is generated from sampleEmitCpp.conf at build time, so its
+// values are compile time constants: they can size arrays, appear in
+// static_asserts and are folded into loops like the one below.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Standard Library
+#include <iostream>
+
+// This Project
+#include "sampleEmitCpp.hpp"
+
+namespace {
+static_assert(sample::detector.geometry.layers == 4, "four layers expected");
+static_assert(sample::detector.geometry.pitch.size() == sample::detector.geometry.layers,
+              "one pitch per layer");
+
+double active_pitch() {
+  double total(0.0);
+  for (int i = 0; i < sample::detector.geometry.layers; ++i) {
+    if (sample::detector.geometry.active & (1ULL << i)) {
+      total += sample::detector.geometry.pitch[i];
+    }
+  }
+  return total;
+}
+}
+
+int main() {
+  double hits[sample::detector.geometry.layers] = {};
+  hits[0] = active_pitch();
+  std::cout << sample::detector.trigger.name << ": threshold "
+            << sample::detector.trigger.threshold << ", active pitch " << hits[0] << std::endl;
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include "catch.hpp"
+#include "BulkConversion.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using warwick::units::Conversion;
+using warwick::units::convert;
+
+namespace {
+const Conversion cFahrenheit = {1.8, 32.0};
+
+std::vector<double> make_input(std::size_t n) {
+  std::vector<double> in(n);
+  for (std::size_t i = 0; i < n; ++i) in[i] = 0.5 * static_cast<double>(i) - 7.0;
+  return in;
+}
+
+// Index of the first value not converted by c, or n if all are
+std::size_t first_mismatch(const std::vector<double>& in, const std::vector<double>& out,
+                           Conversion c) {
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    if (!(out[i] == Approx(c.scale * in[i] + c.offset))) return i;
+  }
+  return in.size();
+}
+} // namespace
+
+TEST_CASE("Arrays either side of the threshold are converted") {
+  // A small threshold forces the threaded split on small arrays. Sizes
+  // below, at and above it, including ones not a multiple of 8
+  const std::size_t threshold = 64;
+  for (std::size_t n : {0u, 1u, 7u, 63u, 64u, 65u, 100u, 1001u, 4099u}) {
+    for (std::size_t threads : {1u, 2u, 3u, 8u}) {
+      const std::vector<double> in = make_input(n);
+      std::vector<double> out(n, std::numeric_limits<double>::quiet_NaN());
+      convert(in.data(), out.data(), n, cFahrenheit, threads, threshold);
+      INFO("n = " << n << ", threads = " << threads);
+      REQUIRE(first_mismatch(in, out, cFahrenheit) == n);
+    }
+  }
+}
+
+TEST_CASE("Arrays are converted in place") {
+  for (std::size_t n : {0u, 5u, 64u, 1001u}) {
+    const std::vector<double> in = make_input(n);
+    INFO("n = " << n);
+
+    std::vector<double> data(in);
+    convert(data.data(), n, cFahrenheit);
+    REQUIRE(first_mismatch(in, data, cFahrenheit) == n);
+
+    data = in;
+    convert(data.data(), data.data(), n, cFahrenheit, 4, 64);
+    REQUIRE(first_mismatch(in, data, cFahrenheit) == n);
+  }
+}
+
+TEST_CASE("Conversions compose") {
+  using warwick::units::cCelsiusToKelvin;
+  const Conversion kelvinToFahrenheit = {1.8, -459.67};
+  const Conversion c = warwick::units::then(cCelsiusToKelvin, kelvinToFahrenheit);
+  REQUIRE(c.scale == Approx(cFahrenheit.scale));
+  REQUIRE(c.offset == Approx(cFahrenheit.offset));
+
+  const Conversion back = warwick::units::then(c, warwick::units::inverse(c));
+  REQUIRE(back.scale == Approx(1.0));
+  REQUIRE(std::abs(back.offset) < 1e-12);
+}
@@ -0,0 +1,92 @@
+#include "catch.hpp"
+#include "ConfigHandle.hpp"
+#include "PropertyPath.hpp"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+bool reload(warwick::ConfigHandle& handle, const std::string& text) {
+  std::istringstream input(text);
+  warwick::ParseErrorList errors;
+  return handle.reload(input, errors);
+}
+
+// No assertions here, as Catch is not thread safe
+int value(const warwick::PropertyList& doc, const std::string& path) {
+  const warwick::Property* p = warwick::find_property(doc, path);
+  return p ? boost::get<int>(p->Value) : -1;
+}
+}
+
+TEST_CASE("Reloading publishes a new snapshot") {
+  warwick::ConfigHandle handle;
+  REQUIRE(handle.version() == 0);
+  REQUIRE(handle.snapshot()->empty());
+
+  REQUIRE(reload(handle, "a : int = 1\n"));
+  warwick::ConfigHandle::Snapshot first = handle.snapshot();
+  REQUIRE(handle.version() == 1);
+  REQUIRE(value(*first, "a") == 1);
+
+  REQUIRE(reload(handle, "a : int = 2\n"));
+  REQUIRE(value(*handle.snapshot(), "a") == 2);
+  // Earlier snapshots are unaffected
+  REQUIRE(value(*first, "a") == 1);
+
+  SECTION("Unchanged documents are not republished") {
+    REQUIRE(reload(handle, "a : int = 2\n"));
+    REQUIRE(handle.version() == 2);
+    REQUIRE_FALSE(handle.publish(*handle.snapshot()));
+    REQUIRE(handle.publish(*first));
+    REQUIRE(handle.version() == 3);
+  }
+
+  SECTION("Failed reloads keep the current document") {
+    REQUIRE_FALSE(reload(handle, "a : int = \n"));
+    REQUIRE(handle.version() == 2);
+    REQUIRE(value(*handle.snapshot(), "a") == 2);
+  }
+
+  SECTION("Readers follow publications") {
+    warwick::ConfigHandle::Reader reader(handle);
+    REQUIRE(value(reader.get(), "a") == 2);
+    REQUIRE(reload(handle, "a : int = 3\n"));
+    REQUIRE(value(reader.get(), "a") == 3);
+    REQUIRE(reader.version() == 3);
+  }
+
+  SECTION("Background reloads report errors") {
+    warwick::ParseErrorList errors = handle.reload_async("/nonexistent/file.conf").get();
+    REQUIRE(errors.size() == 1);
+    REQUIRE(handle.version() == 2);
+  }
+}
+
+TEST_CASE("Readers always see complete documents") {
+  warwick::ConfigHandle handle;
+  REQUIRE(reload(handle, "a : int = 0\nb : int = 0\n"));
+
+  std::atomic<bool> done(false);
+  std::atomic<bool> consistent(true);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; ++t) {
+    readers.emplace_back([&]() {
+      warwick::ConfigHandle::Reader reader(handle);
+      while (!done) {
+        const warwick::PropertyList& doc = reader.get();
+        if (value(doc, "a") != value(doc, "b")) consistent = false;
+      }
+    });
+  }
+  for (int i = 1; i <= 50; ++i) {
+    std::ostringstream text;
+    text << "a : int = " << i << "\nb : int = " << i << "\n";
+    REQUIRE(reload(handle, text.str()));
+  }
+  done = true;
+  for (auto& t : readers) t.join();
+  REQUIRE(consistent);
+}
@@ -0,0 +1,108 @@
+#include "catch.hpp"
+#include "DynQuantity.hpp"
+
+#include <cmath>
+#include <string>
+
+#include "boost/units/systems/cgs/length.hpp"
+#include "boost/units/systems/si.hpp"
+
+namespace si = boost::units::si;
+namespace cgs = boost::units::cgs;
+using warwick::units::dyn_quantity;
+using warwick::units::find_dimension;
+using warwick::units::find_unit;
+using warwick::units::make_dimension;
+
+TEST_CASE("Arithmetic tracks dimensions") {
+  const dyn_quantity width(2.5, find_unit("mm", 2));
+  REQUIRE(width.value() == Approx(2.5e-3));
+  REQUIRE(width.dimension() == find_dimension("length", 6));
+  REQUIRE(width.in(find_unit("um", 2)) == Approx(2500.0));
+  REQUIRE(std::isnan(width.in(find_unit("s", 1))));
+
+  const dyn_quantity area = width * width;
+  REQUIRE(area.value() == Approx(6.25e-6));
+  REQUIRE(area.dimension() == find_dimension("area", 4));
+  REQUIRE((area / width) == width);
+  REQUIRE((width / width).dimension() == warwick::units::cDimensionless);
+  REQUIRE(pow(width, 3).dimension() == find_dimension("volume", 6));
+  REQUIRE(pow(width, -1).value() == Approx(400.0));
+
+  REQUIRE((width + width).value() == Approx(5e-3));
+  REQUIRE((width - 2.0 * width) == -width);
+  REQUIRE((width * 4.0 / 2.0).value() == Approx(5e-3));
+  REQUIRE(width < 2.0 * width);
+  REQUIRE_FALSE(width < area);
+  REQUIRE(width != area);
+}
+
+TEST_CASE("Mismatched and out of range dimensions are invalid") {
+  const dyn_quantity width(1.0, find_unit("m", 1));
+  const dyn_quantity time(1.0, find_unit("s", 1));
+
+  const dyn_quantity sum = width + time;
+  REQUIRE_FALSE(sum.is_valid());
+  REQUIRE(std::isnan(sum.value()));
+  REQUIRE_FALSE((width - time).is_valid());
+
+  // Invalid quantities stay invalid
+  REQUIRE_FALSE((sum * width).is_valid());
+  REQUIRE_FALSE((sum + sum).is_valid());
+
+  // An exponent overflow must not carry into the next dimension
+  const dyn_quantity big(1.0, make_dimension(127));
+  const dyn_quantity product = big * big * dyn_quantity(1.0, make_dimension(2));
+  REQUIRE_FALSE(product.is_valid());
+  REQUIRE_FALSE((dyn_quantity(1.0, make_dimension(-128)) / width).is_valid());
+  REQUIRE_FALSE(pow(big, 2).is_valid());
+  REQUIRE((big / big).dimension() == warwick::units::cDimensionless);
+}
+
+TEST_CASE("Parsed exponents span the full range") {
+  using warwick::units::parse_unit;
+  const std::string smallest("m^-128");
+  REQUIRE(warwick::units::exponent(parse_unit(smallest.data(), smallest.size()).dimension,
+                                   warwick::units::length) == -128);
+  const std::string largest("m^127");
+  REQUIRE(warwick::units::exponent(parse_unit(largest.data(), largest.size()).dimension,
+                                   warwick::units::length) == 127);
+  const std::string tooLarge("m^128");
+  REQUIRE_FALSE(warwick::units::is_valid(parse_unit(tooLarge.data(), tooLarge.size()).dimension));
+  const std::string tooSmall("m^-129");
+  REQUIRE_FALSE(warwick::units::is_valid(parse_unit(tooSmall.data(), tooSmall.size()).dimension));
+
+  // Each exponent is in range, so this fails in the product
+  const std::string product("m^-128 m^-1");
+  REQUIRE_FALSE(warwick::units::is_valid(parse_unit(product.data(), product.size()).dimension));
+}
+
+TEST_CASE("Static quantities convert both ways") {
+  const dyn_quantity force(boost::units::quantity<si::force>(2.0 * si::newtons));
+  REQUIRE(force.dimension() == make_dimension(1, 1, -2));
+  REQUIRE(force.value() == 2.0);
+
+  const dyn_quantity width(boost::units::quantity<cgs::length>(25.0 * cgs::centimeters));
+  REQUIRE(width.dimension() == find_dimension("length", 6));
+  REQUIRE(width.value() == Approx(0.25));
+
+  boost::units::quantity<si::energy> work;
+  REQUIRE(to_quantity(force * width, work));
+  REQUIRE(work.value() == Approx(0.5));
+
+  boost::units::quantity<cgs::length> back;
+  REQUIRE(to_quantity(width, back));
+  REQUIRE(back.value() == Approx(25.0));
+
+  // Round trip through the dynamic type
+  boost::units::quantity<si::velocity> speed;
+  const dyn_quantity v(boost::units::quantity<si::velocity>(3.0 * si::meters_per_second));
+  REQUIRE(to_quantity(v, speed));
+  REQUIRE(speed.value() == 3.0);
+
+  // Mismatches leave the output untouched
+  back = 7.0 * cgs::centimeters;
+  REQUIRE_FALSE(to_quantity(force, back));
+  REQUIRE_FALSE(to_quantity(force + width, back));
+  REQUIRE(back.value() == 7.0);
+}
@@ -0,0 +1,155 @@
+#include "catch.hpp"
+#include "FlatProperty.hpp"
+#include "PropertyEmitter.hpp"
+#include "PropertyParser.hpp"
+#include "SharedProperty.hpp"
+
+#include <cstring>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+const std::string cDocument =
+    "name : string = \"detector\"\n"
+    "version : int = [1, -2, 3]\n"
+    "scale : real = 2.5\n"
+    "active : bool = true\n"
+    "mask : bitset = 0110\n"
+    "name : string = \"tracker\"\n"
+    "geometry : {\n"
+    "  width : real = [10.5, 1e-300]\n"
+    "  layers : {\n"
+    "    count : int = -4\n"
+    "    tags : string = [\"a b\", \"c\"]\n"
+    "  }\n"
+    "}\n";
+
+warwick::PropertyList parse(const std::string& text) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  warwick::PropertyList doc;
+  REQUIRE(parse_document(input, doc));
+  return doc;
+}
+
+/// Copy of buffer with value written at offset at
+template <typename T>
+std::string overwrite(const std::string& buffer, std::size_t at, T value) {
+  std::string result(buffer);
+  std::memcpy(&result[at], &value, sizeof(value));
+  return result;
+}
+
+std::string canonical(const warwick::PropertyList& doc) {
+  std::string text;
+  REQUIRE(warwick::emit_document(doc, text));
+  return text;
+}
+}
+
+TEST_CASE("Flat buffers round trip documents") {
+  const warwick::PropertyList doc = parse(cDocument);
+  std::string buffer;
+  warwick::flatten(doc, buffer);
+
+  warwick::FlatList root;
+  REQUIRE(warwick::open_flat(buffer.data(), buffer.size(), root));
+  REQUIRE(root.size() == doc.size());
+  REQUIRE(root.key(0) == "name");
+  REQUIRE(canonical(root.to_list()) == canonical(doc));
+
+  SECTION("Truncated or corrupt buffers are rejected") {
+    REQUIRE_FALSE(warwick::open_flat(buffer.data(), buffer.size() - 1, root));
+    std::string corrupt(buffer);
+    corrupt[0] = 'X';
+    REQUIRE_FALSE(warwick::open_flat(corrupt.data(), corrupt.size(), root));
+  }
+
+  SECTION("Offsets and counts outside the buffer are rejected") {
+    // Root list at 32, its entries from 40, 24 bytes each
+    const std::size_t name = 40;
+    const std::size_t version = name + 24;
+    const std::size_t geometry = name + 24 * 6;
+    const std::uint64_t past = buffer.size();
+
+    const std::string corrupt[] = {
+        overwrite(buffer, 24, std::uint32_t(past)),
+        overwrite(buffer, 32, std::uint32_t(1 << 30)),
+        overwrite(buffer, name, std::uint32_t(past)),
+        overwrite(buffer, name + 8, std::uint32_t(42)),
+        overwrite(buffer, name + 12, std::uint32_t(1 << 30)),
+        overwrite(buffer, name + 16, past),
+        overwrite(buffer, version + 12, std::uint32_t(1 << 30)),
+        overwrite(buffer, version + 16, std::uint64_t(-8)),
+        overwrite(buffer, geometry + 16, past - 4),
+        overwrite(buffer, geometry + 16, std::uint64_t(32)),
+        overwrite(buffer, 40 + 24 * 7, std::uint32_t(7))};
+    for (const std::string& c : corrupt) {
+      REQUIRE_FALSE(warwick::open_flat(c.data(), c.size(), root));
+    }
+  }
+}
+
+TEST_CASE("Flat buffers are queried in place") {
+  std::string buffer;
+  warwick::flatten(parse(cDocument), buffer);
+  warwick::FlatList root;
+  REQUIRE(warwick::open_flat(buffer.data(), buffer.size(), root));
+
+  warwick::FlatValue v;
+  REQUIRE(root.find("name", v));
+  REQUIRE(v.which() == 3);
+  REQUIRE(v.as_string() == "tracker");
+
+  REQUIRE(root.find("version", v));
+  REQUIRE(v.size() == 3);
+  REQUIRE(v.int_at(1) == -2);
+
+  REQUIRE(root.find("scale", v));
+  REQUIRE(v.as_real() == 2.5);
+  REQUIRE(root.find("active", v));
+  REQUIRE(v.as_bool());
+
+  REQUIRE(root.find("mask", v));
+  REQUIRE(v.size() == 4);
+  REQUIRE(v.bit(1));
+  REQUIRE_FALSE(v.bit(0));
+
+  REQUIRE_FALSE(root.find("missing", v));
+
+  REQUIRE(root.find_path("geometry.layers.count", v));
+  REQUIRE(v.as_int() == -4);
+  REQUIRE(root.find_path("geometry.layers.tags", v));
+  REQUIRE(v.string_at(0) == "a b");
+  REQUIRE(root.find_path("geometry.width", v));
+  REQUIRE(v.real_at(1) == 1e-300);
+  REQUIRE_FALSE(root.find_path("geometry.width.x", v));
+  REQUIRE_FALSE(root.find_path("geometry.depth", v));
+}
+
+TEST_CASE("Documents are published in shared memory") {
+  const std::string name = "/testFlatProperty." + std::to_string(::getpid());
+  const warwick::PropertyList doc = parse(cDocument);
+  std::string error;
+  REQUIRE(warwick::publish_shared(name, doc, error));
+
+  warwick::SharedPropertyMap map;
+  REQUIRE(map.open(name, error));
+  REQUIRE(canonical(map.root().to_list()) == canonical(doc));
+
+  // Republishing leaves existing mappings intact
+  REQUIRE(warwick::publish_shared(name, parse("x : int = 1\n"), error));
+  warwick::FlatValue v;
+  REQUIRE(map.root().find("scale", v));
+  REQUIRE(v.as_real() == 2.5);
+
+  warwick::SharedPropertyMap latest;
+  REQUIRE(latest.open(name, error));
+  REQUIRE(latest.root().find("x", v));
+  REQUIRE(v.as_int() == 1);
+
+  REQUIRE(warwick::unpublish_shared(name));
+  REQUIRE_FALSE(latest.open(name, error));
+  REQUIRE_FALSE(error.empty());
+}
@@ -0,0 +1,165 @@
+#include "catch.hpp"
+#include "ParseCache.hpp"
+#include "PropertyEmitter.hpp"
+#include "PropertyParser.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const std::string cDocument =
+    "name : string = \"detector\"\n"
+    "geometry : {\n"
+    "  width : real = [10.5, 1e-300]\n"
+    "  count : int = 4\n"
+    "}\n";
+
+bool parse(const std::string& text, warwick::PropertyList& doc) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  return parse_document(input, doc);
+}
+
+std::string canonical(const warwick::PropertyList& doc) {
+  std::string text;
+  REQUIRE(warwick::emit_document(doc, text));
+  return text;
+}
+
+/// Names of the files in directory, other than . and ..
+std::vector<std::string> files(const std::string& directory) {
+  std::vector<std::string> names;
+  DIR* dir = ::opendir(directory.c_str());
+  while (struct dirent* e = ::readdir(dir)) {
+    const std::string name(e->d_name);
+    if (name != "." && name != "..") names.push_back(name);
+  }
+  ::closedir(dir);
+  return names;
+}
+
+class TemporaryDirectory {
+ public:
+  TemporaryDirectory() : path_("/tmp/testParseCache." + std::to_string(::getpid())) {
+    ::mkdir(path_.c_str(), 0755);
+  }
+
+  ~TemporaryDirectory() {
+    for (const std::string& f : files(path_)) std::remove((path_ + "/" + f).c_str());
+    ::rmdir(path_.c_str());
+  }
+
+  const std::string& path() const {
+    return path_;
+  }
+
+ private:
+  std::string path_;
+};
+}
+
+TEST_CASE("Parsed documents are cached transparently") {
+  TemporaryDirectory dir;
+  warwick::ParseCache cache(dir.path());
+  warwick::set_parse_cache(&cache);
+
+  warwick::PropertyList first;
+  REQUIRE(parse(cDocument, first));
+  REQUIRE(cache.statistics().misses == 1);
+  REQUIRE(cache.statistics().stores == 1);
+  REQUIRE(files(dir.path()).size() == 1);
+  REQUIRE(files(dir.path())[0].find(".v" + std::to_string(warwick::cParserVersion)) !=
+          std::string::npos);
+
+  warwick::PropertyList second;
+  REQUIRE(parse(cDocument, second));
+  REQUIRE(cache.statistics().hits == 1);
+  REQUIRE(canonical(second) == canonical(first));
+
+  SECTION("Recovering parses share the cache") {
+    warwick::PropertyList third;
+    warwick::ParseErrorList errors;
+    std::istringstream input(cDocument);
+    input.unsetf(std::ios::skipws);
+    REQUIRE(parse_document(input, third, errors));
+    REQUIRE(errors.empty());
+    REQUIRE(cache.statistics().hits == 2);
+    REQUIRE(canonical(third) == canonical(first));
+  }
+
+  SECTION("Failed parses are not cached") {
+    warwick::PropertyList bad;
+    std::cerr << "The following parse failure is expected:" << std::endl;
+    REQUIRE_FALSE(parse("x : int = \n", bad));
+    REQUIRE(cache.statistics().stores == 1);
+  }
+
+  SECTION("Corrupt entries are misses and removed") {
+    const std::string entry = dir.path() + "/" + files(dir.path())[0];
+    std::ofstream(entry, std::ios::trunc) << "garbage";
+    warwick::PropertyList doc;
+    REQUIRE(parse(cDocument, doc));
+    REQUIRE(cache.statistics().misses == 2);
+    REQUIRE(canonical(doc) == canonical(first));
+    REQUIRE(cache.statistics().stores == 2);
+  }
+
+  SECTION("Entries for other texts with the same name are misses") {
+    // As if a different text of the same length had the same hash
+    const std::string entry = dir.path() + "/" + files(dir.path())[0];
+    std::ifstream input(entry, std::ios::binary);
+    std::string buffer((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    REQUIRE(buffer.size() > cDocument.size());
+    buffer[buffer.size() - 2] = 'X';
+    std::ofstream(entry, std::ios::binary | std::ios::trunc) << buffer;
+
+    warwick::PropertyList doc;
+    REQUIRE(parse(cDocument, doc));
+    REQUIRE(cache.statistics().misses == 2);
+    REQUIRE(canonical(doc) == canonical(first));
+  }
+
+  warwick::set_parse_cache(nullptr);
+}
+
+TEST_CASE("The cache evicts least recently used entries") {
+  TemporaryDirectory dir;
+  std::uint64_t entrySize(0);
+  {
+    warwick::ParseCache probe(dir.path());
+    warwick::PropertyList doc;
+    REQUIRE(parse("a : int = 0\n", doc));
+    probe.store("a : int = 0\n", doc);
+    REQUIRE(files(dir.path()).size() == 1);
+    struct stat st;
+    REQUIRE(::stat((dir.path() + "/" + files(dir.path())[0]).c_str(), &st) == 0);
+    entrySize = static_cast<std::uint64_t>(st.st_size);
+    probe.clear();
+    REQUIRE(files(dir.path()).empty());
+  }
+
+  // Room for about four entries
+  warwick::ParseCache cache(dir.path(), 4 * entrySize);
+  for (int i = 0; i < 10; ++i) {
+    std::ostringstream text;
+    text << "a : int = " << i << "\n";
+    warwick::PropertyList doc;
+    REQUIRE(parse(text.str(), doc));
+    cache.store(text.str(), doc);
+  }
+  REQUIRE(cache.statistics().evictions > 0);
+  REQUIRE(files(dir.path()).size() <= 4);
+
+  // The last entry stored survives
+  warwick::PropertyList doc;
+  REQUIRE(cache.load("a : int = 9\n", doc));
+  REQUIRE(canonical(doc) == "a : int = 9\n");
+}
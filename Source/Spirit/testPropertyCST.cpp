@@ -0,0 +1,150 @@
+#include "catch.hpp"
+#include "PropertyCST.hpp"
+#include "PropertyParser.hpp"
+#include "PropertyPath.hpp"
+
+#include <sstream>
+
+namespace {
+const std::string cDocument =
+    "# Release configuration\n"
+    "name : string = \"detector\"   # trailing comment\n"
+    "@description \"Version of the release\"\n"
+    "version : int = [1, 2, 3]\n"
+    "\n"
+    "geometry : {\n"
+    "  # lengths in mm\n"
+    "  width : real = 10.5\n"
+    "  layers : { count : int = 4 }\n"
+    "}\n";
+}
+
+TEST_CASE("CST records token spans") {
+  warwick::PropertyCST cst;
+  warwick::ParseError error;
+  REQUIRE(cst.parse(cDocument, error));
+
+  REQUIRE(cst.entries().size() == 6);
+  REQUIRE(cst.str() == cDocument);
+
+  const warwick::PropertyCST::Entry* e = cst.find("geometry.layers.count");
+  REQUIRE(e != nullptr);
+  REQUIRE(e->type == "int");
+  REQUIRE(cDocument.substr(e->value.offset, e->value.length) == "4");
+
+  e = cst.find("version");
+  REQUIRE(e != nullptr);
+  REQUIRE(cDocument.substr(e->value.offset, e->value.length) == "[1, 2, 3]");
+  REQUIRE(e->description.length > 0);
+
+  e = cst.find("geometry");
+  REQUIRE(e != nullptr);
+  REQUIRE(e->type.empty());
+  REQUIRE(cDocument[e->value.offset] == '{');
+  REQUIRE(cDocument[e->value.offset + e->value.length - 1] == '}');
+
+  // Trivia and tokens between them cover the comments
+  bool foundComment(false);
+  for (const auto& t : cst.trivia()) {
+    if (cDocument.substr(t.offset, t.length).find("# lengths in mm") != std::string::npos) {
+      foundComment = true;
+    }
+  }
+  REQUIRE(foundComment);
+}
+
+TEST_CASE("CST edits patch only the value span") {
+  warwick::PropertyCST cst;
+  warwick::ParseError error;
+  REQUIRE(cst.parse(cDocument, error));
+
+  REQUIRE(cst.set_value("version", "[1, 2, 4]"));
+  REQUIRE(cst.set_value("geometry.width", "12.25"));
+  REQUIRE(cst.edit_count() == 2);
+  REQUIRE(cst.value_text("version") == "[1, 2, 4]");
+
+  std::string expected(cDocument);
+  expected.replace(expected.find("[1, 2, 3]"), 9, "[1, 2, 4]");
+  expected.replace(expected.find("10.5"), 4, "12.25");
+  REQUIRE(cst.str() == expected);
+
+  // Repeated edits replace earlier ones
+  REQUIRE(cst.set_value("version", "7"));
+  REQUIRE(cst.edit_count() == 2);
+
+  SECTION("Invalid edits are rejected") {
+    REQUIRE_FALSE(cst.set_value("version", "seven"));
+    REQUIRE_FALSE(cst.set_value("name", "unquoted"));
+    REQUIRE_FALSE(cst.set_value("geometry", "1"));
+    REQUIRE_FALSE(cst.set_value("missing", "1"));
+    REQUIRE(cst.value_text("version") == "7");
+  }
+}
+
+TEST_CASE("CST edits the last of duplicated keys") {
+  const std::string text = "a : int = 1\nb : int = 2\na : int = 3\n";
+  warwick::PropertyCST cst;
+  warwick::ParseError error;
+  REQUIRE(cst.parse(text, error));
+  REQUIRE(cst.value_text("a") == "3");
+  REQUIRE(cst.set_value("a", "4"));
+  REQUIRE(cst.str() == "a : int = 1\nb : int = 2\na : int = 4\n");
+
+  std::istringstream input(cst.str());
+  input.unsetf(std::ios::skipws);
+  warwick::PropertyList doc;
+  REQUIRE(parse_document(input, doc));
+  const warwick::Property* p = warwick::find_property(doc, "a");
+  REQUIRE(p != nullptr);
+  REQUIRE(boost::get<int>(p->Value) == 4);
+}
+
+TEST_CASE("CST rejects invalid documents") {
+  warwick::PropertyCST cst;
+  warwick::ParseError error;
+  REQUIRE_FALSE(cst.parse("a : int = 1\nb : { c : int = x }\n", error));
+  REQUIRE(error.line == 2);
+  REQUIRE(error.column == 17);
+  REQUIRE_FALSE(cst.parse("a : { b : int = 1\n", error));
+  REQUIRE_FALSE(cst.parse("a : {}\n", error));
+}
+
+TEST_CASE("CST edits quantities") {
+  const std::string text =
+      "width : real as length = 3 mm  # nominal\n"
+      "gaps : real as length = [1 mm, 0.5 cm]\n"
+      "ratio : real as dimensionless = 0.5\n";
+  warwick::PropertyCST cst;
+  warwick::ParseError error;
+  REQUIRE(cst.parse(text, error));
+  REQUIRE(cst.str() == text);
+
+  const warwick::PropertyCST::Entry* e = cst.find("width");
+  REQUIRE(e != nullptr);
+  REQUIRE(e->type == "real as length");
+  REQUIRE(cst.value_text("width") == "3 mm");
+  REQUIRE(cst.value_text("gaps") == "[1 mm, 0.5 cm]");
+  REQUIRE(cst.value_text("ratio") == "0.5");
+
+  REQUIRE(cst.set_value("width", "2.5 cm"));
+  REQUIRE(cst.set_value("gaps", "[2 mm, 1 m, 3 um]"));
+  REQUIRE_FALSE(cst.set_value("width", "2.5 s"));
+  REQUIRE_FALSE(cst.set_value("gaps", "[2 mm, 1 kg]"));
+  REQUIRE_FALSE(cst.set_value("ratio", "1 m"));
+
+  const std::string expected =
+      "width : real as length = 2.5 cm  # nominal\n"
+      "gaps : real as length = [2 mm, 1 m, 3 um]\n"
+      "ratio : real as dimensionless = 0.5\n";
+  REQUIRE(cst.str() == expected);
+
+  // The written document reads back with the edited values in SI units
+  std::istringstream input(cst.str());
+  input.unsetf(std::ios::skipws);
+  warwick::PropertyList doc;
+  REQUIRE(parse_document(input, doc));
+  REQUIRE(boost::get<double>(doc[0].Value) == Approx(0.025));
+  REQUIRE(boost::get<std::vector<double> >(doc[1].Value)[2] == Approx(3e-6));
+
+  REQUIRE_FALSE(cst.parse("width : real as length = 3 s\n", error));
+}
@@ -0,0 +1,91 @@
+#include "catch.hpp"
+#include "PropertyCpp.hpp"
+#include "PropertyParser.hpp"
+
+#include <sstream>
+
+namespace {
+warwick::PropertyList parse(const std::string& text) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  warwick::PropertyList doc;
+  REQUIRE(parse_document(input, doc));
+  return doc;
+}
+
+bool emit(const std::string& text, std::string& header, std::string& error) {
+  warwick::CppOptions options;
+  options.name = "detector";
+  options.nameSpace = "config::frozen";
+  return warwick::emit_cpp(parse(text), options, header, error);
+}
+}
+
+TEST_CASE("Documents compile to aggregate structs") {
+  const std::string text =
+      "name : string = \"a \\ b\"\n"
+      "mask : bitset = 0110\n"
+      "geometry : {\n"
+      "  width : real = [10.5, 2]\n"
+      "  count : int = -2147483648\n"
+      "  count : int = 4\n"
+      "}\n"
+      "class : bool = true\n";
+  std::string header;
+  std::string error;
+  REQUIRE(emit(text, header, error));
+
+  const std::string expected =
+      "namespace config {\n"
+      "namespace frozen {\n"
+      "struct detector_type {\n"
+      "  struct geometry_type {\n"
+      "    std::array<double, 2> width;\n"
+      "    int count;\n"
+      "  };\n"
+      "  const char* name;\n"
+      "  unsigned long long mask;\n"
+      "  geometry_type geometry;\n"
+      "  bool class_;\n"
+      "};\n"
+      "\n"
+      "constexpr detector_type detector = "
+      "{\"a \\\\ b\", 0b0110ULL, {{{10.5, 2.0}}, 4}, true};\n"
+      "} // namespace frozen\n"
+      "} // namespace config\n";
+  REQUIRE(header.find(expected) != std::string::npos);
+  REQUIRE(header.find("#ifndef CONFIG__FROZEN_DETECTOR_HH") != std::string::npos);
+}
+
+TEST_CASE("Values without a C++ form are rejected") {
+  std::string header;
+  std::string error;
+  warwick::CppOptions options;
+  options.name = "detector";
+  warwick::PropertyList doc(1);
+  doc[0].Key = "mask";
+  doc[0].Value = boost::dynamic_bitset<>(65);
+  REQUIRE_FALSE(warwick::emit_cpp(doc, options, header, error));
+  REQUIRE(error.find("64 bits") != std::string::npos);
+
+  REQUIRE_FALSE(emit("a_type : int = 1\na : {\n  b : int = 2\n}\n", header, error));
+  REQUIRE(error.find("clashes") != std::string::npos);
+
+  // Nested types may not share the name of the struct they are in
+  REQUIRE_FALSE(emit("a : {\n  a : {\n    x : int = 1\n  }\n}\n", header, error));
+  REQUIRE(error.find("clashes") != std::string::npos);
+  REQUIRE_FALSE(emit("detector : {\n  x : int = 1\n}\n", header, error));
+  REQUIRE(error.find("clashes") != std::string::npos);
+  REQUIRE_FALSE(emit("a : {\n  a_type : int = 1\n}\n", header, error));
+  REQUIRE(error.find("clashes") != std::string::npos);
+
+  // Keywords are renamed, and may then meet another key
+  REQUIRE_FALSE(emit("int : int = 1\nint_ : int = 2\n", header, error));
+  REQUIRE(error.find("clashes") != std::string::npos);
+  REQUIRE_FALSE(emit("a : {\n  class_ : int = 1\n  class : int = 2\n}\n", header, error));
+  REQUIRE(error.find("clashes") != std::string::npos);
+  REQUIRE(emit("a : {\n  b : {\n    a : {\n      x : int = 1\n    }\n  }\n}\n", header, error));
+
+  options.name = "int";
+  REQUIRE_FALSE(warwick::emit_cpp(warwick::PropertyList(), options, header, error));
+}
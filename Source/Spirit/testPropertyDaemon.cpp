@@ -0,0 +1,156 @@
+#include "catch.hpp"
+#include "PropertyClient.hpp"
+#include "PropertyDaemon.hpp"
+#include "PropertyPath.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+namespace {
+std::string temp_path(const std::string& name) {
+  return "/tmp/testPropertyDaemon." + std::to_string(::getpid()) + "." + name;
+}
+
+void write_file(const std::string& path, const std::string& text) {
+  std::ofstream out(path);
+  out << text;
+}
+
+const std::string cDocument =
+    "name : string = \"detector\"\n"
+    "geometry : {\n"
+    "  width : real = 10.5\n"
+    "  layers : { count : int = 4 }\n"
+    "}\n";
+}
+
+TEST_CASE("Properties are found by dotted path") {
+  std::istringstream input(cDocument);
+  input.unsetf(std::ios::skipws);
+  warwick::PropertyList doc;
+  REQUIRE(parse_document(input, doc));
+
+  const warwick::Property* p = warwick::find_property(doc, "geometry.layers.count");
+  REQUIRE(p != nullptr);
+  REQUIRE(boost::get<int>(p->Value) == 4);
+  REQUIRE(warwick::find_property(doc, "name") != nullptr);
+  REQUIRE(warwick::find_property(doc, "geometry.layers") != nullptr);
+  REQUIRE(warwick::find_property(doc, "geometry.depth") == nullptr);
+  REQUIRE(warwick::find_property(doc, "name.x") == nullptr);
+  REQUIRE(warwick::find_property(doc, "geometry.") == nullptr);
+  REQUIRE(warwick::find_property(doc, "") == nullptr);
+}
+
+TEST_CASE("Daemon answers requests from its cache") {
+  const std::string file = temp_path("doc.conf");
+  const std::string schema = temp_path("schema.conf");
+  write_file(file, cDocument);
+  write_file(schema, "name : { type : string = \"int\" }\n");
+
+  warwick::PropertyDaemon daemon;
+  REQUIRE(daemon.handle("PARSE " + file) == "OK 0\n");
+  REQUIRE(daemon.handle("PARSE " + file) == "OK 0\n");
+  REQUIRE(daemon.handle("QUERY geometry.width " + file) == "OK 1\nreal = 10.5\n");
+  REQUIRE(daemon.handle("QUERY geometry.layers " + file) == "OK 3\n{\n  count : int = 4\n}\n");
+  REQUIRE(daemon.handle("QUERY geometry.depth " + file) ==
+          "ERR 1\nno property \"geometry.depth\"\n");
+
+  warwick::PropertyDaemon::Statistics s = daemon.statistics();
+  REQUIRE(s.misses == 1);
+  REQUIRE(s.hits == 4);
+  REQUIRE(s.entries == 1);
+
+  // Validation results are cached separately from plain parses
+  REQUIRE(daemon.handle("VALIDATE " + schema + " " + file) ==
+          "ERR 2\n1:1: property 'name' must be of type int, not string\n"
+          "2:1: unknown property 'geometry'\n");
+  REQUIRE(daemon.statistics().entries == 2);
+
+  // Changed content is a new cache entry
+  write_file(file, "name : int = \n");
+  REQUIRE(daemon.handle("PARSE " + file).compare(0, 6, "ERR 1\n") == 0);
+  REQUIRE(daemon.statistics().misses == 3);
+
+  REQUIRE(daemon.handle("PARSE " + temp_path("missing")).compare(0, 6, "ERR 1\n") == 0);
+  REQUIRE(daemon.handle("FROB x") == "ERR 1\nunknown request \"FROB\"\n");
+
+  std::remove(file.c_str());
+  std::remove(schema.c_str());
+}
+
+TEST_CASE("Client talks to daemon over a socket") {
+  const std::string socket = temp_path("sock");
+  const std::string file = temp_path("client.conf");
+  write_file(file, cDocument);
+
+  warwick::PropertyDaemon daemon(16);
+  std::string error;
+  REQUIRE(daemon.listen(socket, error));
+  std::thread server(&warwick::PropertyDaemon::serve, &daemon);
+
+  {
+    warwick::PropertyClient client;
+    REQUIRE(client.connect(socket));
+    warwick::PropertyClient::Response r;
+    REQUIRE(client.parse(file, r));
+    REQUIRE(r.ok);
+    REQUIRE(client.query(file, "geometry.layers.count", r));
+    REQUIRE(r.ok);
+    REQUIRE(r.lines == std::vector<std::string>{"int = 4"});
+
+    write_file(file, "a : int = 1\nb : int = x\n");
+    REQUIRE(client.parse(file, r));
+    REQUIRE_FALSE(r.ok);
+    warwick::ParseErrorList errors = warwick::PropertyClient::errors(r);
+    REQUIRE(errors.size() == 1);
+    REQUIRE(errors[0].line == 2);
+    REQUIRE(errors[0].column == 11);
+  }
+
+  {
+    // Overlong requests are answered once, and the connection recovers
+    warwick::PropertyClient client;
+    REQUIRE(client.connect(socket));
+    warwick::PropertyClient::Response r;
+    REQUIRE(client.request("PARSE " + std::string(200000, 'x'), r));
+    REQUIRE_FALSE(r.ok);
+    REQUIRE(r.lines == std::vector<std::string>{"request too long"});
+    REQUIRE(client.request("STATS", r));
+    REQUIRE(r.ok);
+  }
+
+  daemon.stop();
+  server.join();
+  REQUIRE(::access(socket.c_str(), F_OK) != 0);
+  std::remove(file.c_str());
+}
+
+TEST_CASE("Daemon only replaces stale sockets") {
+  const std::string path = temp_path("notasocket");
+  write_file(path, cDocument);
+  std::string error;
+  {
+    warwick::PropertyDaemon daemon;
+    REQUIRE_FALSE(daemon.listen(path, error));
+    REQUIRE(error.find("not a socket") != std::string::npos);
+  }
+  std::ifstream input(path);
+  REQUIRE(input.good());
+  std::remove(path.c_str());
+
+  // A file put in place of the socket is left alone on stop
+  const std::string socket = temp_path("replaced");
+  {
+    warwick::PropertyDaemon daemon;
+    REQUIRE(daemon.listen(socket, error));
+    std::remove(socket.c_str());
+    write_file(socket, cDocument);
+    daemon.stop();
+  }
+  REQUIRE(::access(socket.c_str(), F_OK) == 0);
+  std::remove(socket.c_str());
+}
@@ -0,0 +1,138 @@
+#include "catch.hpp"
+#include "ConfigHandle.hpp"
+#include "PropertyDiff.hpp"
+#include "PropertyParser.hpp"
+
+#include <sstream>
+
+namespace {
+warwick::PropertyList parse(const std::string& text) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  warwick::PropertyList doc;
+  REQUIRE(parse_document(input, doc));
+  return doc;
+}
+
+std::string describe(const warwick::PropertyChangeList& changes) {
+  std::string result;
+  for (const auto& c : changes) {
+    result += c.kind == warwick::PropertyChange::Added
+                  ? "+"
+                  : c.kind == warwick::PropertyChange::Removed ? "-" : "~";
+    result += c.path + " ";
+  }
+  return result;
+}
+
+const std::string cBefore =
+    "name : string = \"detector\"\n"
+    "geometry : {\n"
+    "  width : real = 10.5\n"
+    "  layers : {\n"
+    "    count : int = 4\n"
+    "    tags : string = [\"a\", \"b\"]\n"
+    "  }\n"
+    "}\n"
+    "trigger : {\n"
+    "  rate : int = 100\n"
+    "}\n";
+}
+
+TEST_CASE("Identical documents have no differences") {
+  REQUIRE(warwick::diff_documents(parse(cBefore), parse(cBefore)).empty());
+  REQUIRE(warwick::diff_documents(warwick::PropertyList(), warwick::PropertyList()).empty());
+}
+
+TEST_CASE("Differences are reported by path") {
+  const warwick::PropertyList before = parse(cBefore);
+
+  SECTION("Changed leaves deep in a tree") {
+    const std::string after =
+        "name : string = \"detector\"\n"
+        "geometry : {\n"
+        "  width : real = 10.5\n"
+        "  layers : {\n"
+        "    count : int = 5\n"
+        "    tags : string = [\"a\", \"c\"]\n"
+        "  }\n"
+        "}\n"
+        "trigger : {\n"
+        "  rate : int = 100\n"
+        "}\n";
+    REQUIRE(describe(warwick::diff_documents(before, parse(after))) ==
+            "~geometry.layers.count ~geometry.layers.tags ");
+  }
+
+  SECTION("Added, removed and retyped properties") {
+    const std::string after =
+        "name : string = \"detector\"\n"
+        "geometry : {\n"
+        "  width : int = 10\n"
+        "  depth : real = 2\n"
+        "}\n"
+        "trigger : int = 1\n"
+        "beam : {\n"
+        "  energy : real = 7\n"
+        "}\n";
+    REQUIRE(describe(warwick::diff_documents(before, parse(after))) ==
+            "+beam +geometry.depth -geometry.layers ~geometry.width ~trigger ");
+  }
+
+  SECTION("Order and earlier duplicates do not matter") {
+    const std::string after =
+        "trigger : {\n"
+        "  rate : int = 100\n"
+        "}\n"
+        "name : string = \"old\"\n"
+        "geometry : {\n"
+        "  layers : {\n"
+        "    tags : string = [\"a\", \"b\"]\n"
+        "    count : int = 4\n"
+        "  }\n"
+        "  width : real = 10.5\n"
+        "}\n"
+        "name : string = \"detector\"\n";
+    REQUIRE(warwick::diff_documents(before, parse(after)).empty());
+  }
+}
+
+TEST_CASE("Subscribers are notified of changes under their prefix") {
+  warwick::ChangeNotifier notifier;
+  std::string geometry;
+  std::string layers;
+  std::string trigger;
+  std::string all;
+  notifier.subscribe("geometry",
+                     [&](const warwick::PropertyChangeList& c) { geometry += describe(c); });
+  notifier.subscribe("geometry.layers",
+                     [&](const warwick::PropertyChangeList& c) { layers += describe(c); });
+  auto id = notifier.subscribe(
+      "trigger", [&](const warwick::PropertyChangeList& c) { trigger += describe(c); });
+  notifier.subscribe("", [&](const warwick::PropertyChangeList& c) { all += describe(c); });
+
+  warwick::ConfigHandle handle(parse(cBefore));
+  handle.set_notifier(&notifier);
+
+  handle.publish(parse(
+      "name : string = \"detector\"\n"
+      "geometry : {\n"
+      "  width : real = 11\n"
+      "}\n"
+      "trigger : {\n"
+      "  rate : int = 100\n"
+      "}\n"));
+  REQUIRE(geometry == "-geometry.layers ~geometry.width ");
+  REQUIRE(layers == "-geometry.layers ");
+  REQUIRE(trigger.empty());
+  REQUIRE(all == geometry);
+
+  notifier.unsubscribe(id);
+  handle.publish(parse("name : string = \"detector\"\n"));
+  REQUIRE(trigger.empty());
+  // Removing an enclosing tree concerns everything below it
+  REQUIRE(layers == "-geometry.layers -geometry ");
+  REQUIRE(all == "-geometry.layers ~geometry.width -geometry -trigger ");
+
+  handle.set_notifier(nullptr);
+}
@@ -0,0 +1,98 @@
+#include "catch.hpp"
+#include "PropertyEmitter.hpp"
+#include "PropertyParser.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <sstream>
+
+namespace {
+bool reparse(const std::string& text, warwick::PropertyList& output) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  return parse_document(input, output);
+}
+
+const std::string cCanonical =
+    "name : string = \"detector\"\n"
+    "version : int = [1, -2, 3]\n"
+    "scale : real = 0.1\n"
+    "active : bool = false\n"
+    "mask : bitset = 0110\n"
+    "geometry : {\n"
+    "  width : real = [10.5, 1e-300]\n"
+    "  layers : {\n"
+    "    count : int = 4\n"
+    "    tags : string = [\"a b\", \"c\"]\n"
+    "  }\n"
+    "}\n";
+}
+
+TEST_CASE("Canonical documents are emitted unchanged") {
+  warwick::PropertyList doc;
+  REQUIRE(reparse(cCanonical, doc));
+
+  std::string text;
+  REQUIRE(warwick::emit_document(doc, text));
+  REQUIRE(text == cCanonical);
+
+  std::ostringstream os;
+  REQUIRE(warwick::emit_document(doc, os));
+  REQUIRE(os.str() == cCanonical);
+}
+
+TEST_CASE("Emitted documents round trip") {
+  warwick::PropertyList doc;
+  REQUIRE(reparse("a:int=7 b:{c:{d:real=[1.0,2.5]}} e : string = \"x\"", doc));
+
+  std::string first;
+  REQUIRE(warwick::emit_document(doc, first));
+  warwick::PropertyList again;
+  REQUIRE(reparse(first, again));
+  std::string second;
+  REQUIRE(warwick::emit_document(again, second));
+  REQUIRE(first == second);
+}
+
+TEST_CASE("Reals round trip exactly") {
+  std::mt19937_64 engine(42);
+  std::uniform_real_distribution<double> exponent(-300, 300);
+  std::uniform_real_distribution<double> mantissa(-1, 1);
+
+  std::vector<double> values = {0.1, 1.0 / 3.0, -0.0, 5e-324,
+                                std::numeric_limits<double>::max(),
+                                std::numeric_limits<double>::min()};
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(mantissa(engine) * std::pow(10.0, exponent(engine)));
+  }
+
+  warwick::PropertyList doc = {warwick::Property{"x", values}};
+  std::string text;
+  REQUIRE(warwick::emit_document(doc, text));
+
+  warwick::PropertyList output;
+  REQUIRE(reparse(text, output));
+  const auto& result = boost::get<std::vector<double> >(output.at(0).Value);
+  REQUIRE(result.size() == values.size());
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    REQUIRE(result[i] == values[i]);
+  }
+}
+
+TEST_CASE("Unrepresentable values are rejected") {
+  using warwick::Property;
+  std::string text;
+
+  REQUIRE_FALSE(warwick::emit_document({Property{"s", std::string()}}, text));
+  REQUIRE_FALSE(warwick::emit_document({Property{"s", std::string("a\"b")}}, text));
+  REQUIRE_FALSE(warwick::emit_document({Property{"v", std::vector<int>()}}, text));
+  REQUIRE_FALSE(warwick::emit_document({Property{"t", warwick::PropertyList()}}, text));
+  REQUIRE_FALSE(warwick::emit_document({Property{"b", boost::dynamic_bitset<>(65)}}, text));
+  REQUIRE_FALSE(warwick::emit_document({Property{"1x", 1}}, text));
+  REQUIRE_FALSE(warwick::emit_document({Property{"bad key", 1}}, text));
+
+  text.clear();
+  REQUIRE(warwick::emit_document({Property{"ok_1", 1}}, text));
+  REQUIRE(text == "ok_1 : int = 1\n");
+}
@@ -0,0 +1,87 @@
+#include "catch.hpp"
+#include "PropertyHash.hpp"
+#include "PropertyParser.hpp"
+
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace {
+warwick::PropertyList parse(const std::string& text) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  warwick::PropertyList doc;
+  REQUIRE(parse_document(input, doc));
+  return doc;
+}
+
+const std::string cDocument =
+    "name : string = \"detector\"\n"
+    "version : int = [1, -2, 3]\n"
+    "scale : real = 2.5\n"
+    "active : bool = true\n"
+    "mask : bitset = 0110\n"
+    "geometry : {\n"
+    "  width : real = [10.5, 1e-300]\n"
+    "  layers : {\n"
+    "    count : int = -4\n"
+    "    tags : string = [\"a b\", \"c\"]\n"
+    "  }\n"
+    "}\n";
+}
+
+TEST_CASE("Hashes are stable") {
+  // Fixed values, which must not change between runs or platforms as
+  // hashes may be stored as cache keys
+  REQUIRE(warwick::hash_document(warwick::PropertyList()) == 0x2c3955f8b7d41bbaULL);
+  REQUIRE(warwick::hash_document(parse(cDocument)) == 0x0dbada98d2143ba0ULL);
+}
+
+TEST_CASE("Hashes depend on content") {
+  const warwick::PropertyList doc = parse(cDocument);
+  const std::uint64_t h = warwick::hash_document(doc);
+  REQUIRE(warwick::hash_document(parse(cDocument)) == h);
+
+  const std::pair<const char*, const char*> edits[] = {
+      {"scale : real = 2.5", "scale : real = 2.50001"},
+      {"scale : real = 2.5", "scale : int = 2"},
+      {"scale : real = 2.5", "Scale : real = 2.5"},
+      {"mask : bitset = 0110", "mask : bitset = 00110"},
+      {"count : int = -4", "count : int = 4"},
+      {"[\"a b\", \"c\"]", "[\"a\", \"b c\"]"}};
+  REQUIRE(warwick::same_document(parse(cDocument), doc));
+  for (const auto& e : edits) {
+    std::string text(cDocument);
+    text.replace(text.find(e.first), std::strlen(e.first), e.second);
+    REQUIRE(warwick::hash_document(parse(text)) != h);
+    REQUIRE_FALSE(warwick::same_document(parse(text), doc));
+  }
+
+  // Only the bit pattern of NaN is normalised, not the sign of zero
+  warwick::Property a{"x", std::numeric_limits<double>::quiet_NaN()};
+  warwick::Property b{"x", -std::numeric_limits<double>::quiet_NaN()};
+  REQUIRE(warwick::hash_property(a) == warwick::hash_property(b));
+  REQUIRE(warwick::same_property(a, b));
+  a.Value = 0.0;
+  b.Value = -0.0;
+  REQUIRE(warwick::hash_property(a) != warwick::hash_property(b));
+  REQUIRE_FALSE(warwick::same_property(a, b));
+}
+
+TEST_CASE("Document hashes index every subtree") {
+  const warwick::PropertyList doc = parse(cDocument);
+  const warwick::DocumentHash hash(doc);
+  REQUIRE(hash.root() == warwick::hash_document(doc));
+  REQUIRE(hash.size() == 10);
+
+  // geometry is the sixth property, with width, layers and its children
+  REQUIRE(hash.subtree_size(5) == 5);
+  REQUIRE(hash.hash(5) == warwick::hash_property(doc[5]));
+  REQUIRE(hash.subtree_size(7) == 3);
+  REQUIRE(hash.hash(9) == warwick::hash_property(
+                              boost::get<warwick::PropertyList>(
+                                  boost::get<warwick::PropertyList>(doc[5].Value)[1].Value)[1]));
+
+  REQUIRE(hash == warwick::DocumentHash(parse(cDocument)));
+  REQUIRE(hash != warwick::DocumentHash());
+}
@@ -0,0 +1,204 @@
+#include "catch.hpp"
+#include "PropertyEmitter.hpp"
+#include "PropertyJSON.hpp"
+#include "PropertyYAML.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace {
+/// Stream buffer that discards its output, recording the largest write
+class LargestWrite : public std::streambuf {
+ public:
+  std::size_t largest = 0;
+  std::size_t total = 0;
+
+ protected:
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    largest = std::max(largest, static_cast<std::size_t>(n));
+    total += static_cast<std::size_t>(n);
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    return xsputn(nullptr, 1) ? c : traits_type::eof();
+  }
+};
+
+bool reparse(const std::string& text, warwick::PropertyList& output) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  return parse_document(input, output);
+}
+
+const std::string cDocument =
+    "name : string = \"detector\"\n"
+    "version : int = [1, -2, 3]\n"
+    "scale : real = 2\n"
+    "active : bool = false\n"
+    "mask : bitset = 0110\n"
+    "geometry : {\n"
+    "  width : real = [10.5, 1e-300]\n"
+    "  layers : {\n"
+    "    count : int = 4\n"
+    "    tags : string = [\"a b\", \"c\"]\n"
+    "  }\n"
+    "}\n";
+
+const std::string cJSON =
+    "{\n"
+    "  \"name\": \"detector\",\n"
+    "  \"version\": [1, -2, 3],\n"
+    "  \"scale\": 2.0,\n"
+    "  \"active\": false,\n"
+    "  \"mask\": \"0b0110\",\n"
+    "  \"geometry\": {\n"
+    "    \"width\": [10.5, 1e-300],\n"
+    "    \"layers\": {\n"
+    "      \"count\": 4,\n"
+    "      \"tags\": [\"a b\", \"c\"]\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
+const std::string cYAML =
+    "name: \"detector\"\n"
+    "version: [1, -2, 3]\n"
+    "scale: 2.0\n"
+    "active: false\n"
+    "mask: !bitset \"0110\"\n"
+    "geometry:\n"
+    "  width: [10.5, 1e-300]\n"
+    "  layers:\n"
+    "    count: 4\n"
+    "    tags: [\"a b\", \"c\"]\n";
+}
+
+TEST_CASE("Documents are written as JSON") {
+  warwick::PropertyList doc;
+  REQUIRE(reparse(cDocument, doc));
+
+  std::string text;
+  REQUIRE(warwick::write_json(doc, text));
+  REQUIRE(text == cJSON);
+
+  std::ostringstream os;
+  REQUIRE(warwick::write_json(doc, os));
+  REQUIRE(os.str() == cJSON);
+
+  text.clear();
+  REQUIRE(warwick::write_json(warwick::PropertyList(), text));
+  REQUIRE(text == "{}\n");
+
+  text.clear();
+  doc = {warwick::Property{"x", std::numeric_limits<double>::infinity()}};
+  REQUIRE_FALSE(warwick::write_json(doc, text));
+}
+
+TEST_CASE("JSON is read back to the same document") {
+  warwick::PropertyList doc;
+  warwick::ParseError error;
+  REQUIRE(warwick::read_json(cJSON, doc, error));
+
+  std::string text;
+  REQUIRE(warwick::emit_document(doc, text));
+  REQUIRE(text == cDocument);
+}
+
+TEST_CASE("JSON values map onto property types") {
+  warwick::PropertyList doc;
+  warwick::ParseError error;
+  REQUIRE(warwick::read_json("{\"a\": [1, 2.5], \"b\": 1e3, \"c\": 3000000000,"
+                             " \"d\": \"q\\\"\\u00e9\\ud83d\\ude00\", \"e\": {}}",
+                             doc, error));
+  REQUIRE(doc.size() == 5);
+  REQUIRE(boost::get<std::vector<double> >(doc[0].Value) == std::vector<double>({1.0, 2.5}));
+  REQUIRE(boost::get<double>(doc[1].Value) == 1000.0);
+  REQUIRE(boost::get<double>(doc[2].Value) == 3e9);
+  REQUIRE(boost::get<std::string>(doc[3].Value) == "q\"\xc3\xa9\xf0\x9f\x98\x80");
+  REQUIRE(boost::get<warwick::PropertyList>(doc[4].Value).empty());
+
+  std::string text;
+  REQUIRE(warwick::write_json(doc, text));
+  warwick::PropertyList again;
+  REQUIRE(warwick::read_json(text, again, error));
+  REQUIRE(boost::get<std::string>(again[3].Value) == boost::get<std::string>(doc[3].Value));
+}
+
+TEST_CASE("Large arrays are streamed in blocks") {
+  // Each array alone is many blocks long
+  const std::size_t n = 16 * warwick::OutputBuffer::cBlockSize;
+  const warwick::PropertyList doc = {
+      warwick::Property{"i", std::vector<int>(n, -123456)},
+      warwick::Property{"r", std::vector<double>(n, 0.125)},
+      warwick::Property{"s", std::vector<std::string>(n / 4, "abcdef")}};
+  // Blocks overrun the block size by at most one element
+  const std::size_t limit = warwick::OutputBuffer::cBlockSize + 64;
+
+  LargestWrite json;
+  std::ostream jsonStream(&json);
+  REQUIRE(warwick::write_json(doc, jsonStream));
+  REQUIRE(json.total > 16 * limit);
+  REQUIRE(json.largest <= limit);
+
+  LargestWrite yaml;
+  std::ostream yamlStream(&yaml);
+  warwick::write_yaml(doc, yamlStream);
+  REQUIRE(yaml.total > 16 * limit);
+  REQUIRE(yaml.largest <= limit);
+
+  LargestWrite native;
+  std::ostream nativeStream(&native);
+  REQUIRE(warwick::emit_document(doc, nativeStream));
+  REQUIRE(native.total > 16 * limit);
+  REQUIRE(native.largest <= limit);
+}
+
+TEST_CASE("Invalid JSON is reported by position") {
+  warwick::PropertyList doc;
+  warwick::ParseError error;
+
+  REQUIRE_FALSE(warwick::read_json("{\n  \"a\": [1, \"x\"]\n}", doc, error));
+  REQUIRE(error.line == 2);
+  REQUIRE(error.column == 9);
+  REQUIRE(error.message == "expected <non-empty array of numbers or strings>");
+
+  REQUIRE_FALSE(warwick::read_json("{\"a\": []}", doc, error));
+  REQUIRE_FALSE(warwick::read_json("{\"a\": null}", doc, error));
+  REQUIRE(error.message == "expected <value>");
+  REQUIRE_FALSE(warwick::read_json("{\"a\": 1} x", doc, error));
+  REQUIRE(error.message == "expected end of input");
+  REQUIRE_FALSE(warwick::read_json("[1]", doc, error));
+
+  // Surrogates must come in high, low pairs
+  REQUIRE_FALSE(warwick::read_json("{\"a\": \"\\uD800\\u0041\"}", doc, error));
+  REQUIRE(error.message == "expected <low surrogate>");
+  REQUIRE_FALSE(warwick::read_json("{\"a\": \"\\uD800\\uD800\"}", doc, error));
+  REQUIRE(error.message == "expected <low surrogate>");
+  REQUIRE_FALSE(warwick::read_json("{\"a\": \"\\uD800x\"}", doc, error));
+  REQUIRE(error.column == 14);
+  REQUIRE_FALSE(warwick::read_json("{\"a\": \"\\uDC00\"}", doc, error));
+  REQUIRE(error.message == "expected <4 hex digits, not a low surrogate>");
+  REQUIRE(warwick::read_json("{\"a\": \"\\uD7FF\\uE000\\uDBFF\\uDFFF\"}", doc, error));
+  REQUIRE(boost::get<std::string>(doc[0].Value) == "\xed\x9f\xbf\xee\x80\x80\xf4\x8f\xbf\xbf");
+}
+
+TEST_CASE("Documents are written as YAML") {
+  warwick::PropertyList doc;
+  REQUIRE(reparse(cDocument, doc));
+
+  std::string text;
+  warwick::write_yaml(doc, text);
+  REQUIRE(text == cYAML);
+
+  std::ostringstream os;
+  warwick::write_yaml(doc, os);
+  REQUIRE(os.str() == cYAML);
+
+  text.clear();
+  doc = {warwick::Property{"on", std::numeric_limits<double>::quiet_NaN()},
+         warwick::Property{"t", warwick::PropertyList()}};
+  warwick::write_yaml(doc, text);
+  REQUIRE(text == "\"on\": .nan\nt: {}\n");
+}
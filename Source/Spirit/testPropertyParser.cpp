@@ -0,0 +1,277 @@
+#include "catch.hpp"
+#include "LineIndex.hpp"
+#include "PropertyParser.hpp"
+
+#include <sstream>
+
+namespace {
+bool parse_text(const std::string& text, warwick::PropertyList& output) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  return parse_document(input, output);
+}
+
+bool parse_text(const std::string& text,
+                warwick::PropertyList& output,
+                warwick::PropertyDescriptions& descriptions) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  return parse_document(input, output, descriptions);
+}
+}
+
+TEST_CASE("Parse basic document") {
+  warwick::PropertyList doc;
+  REQUIRE(parse_text("a : int = 1\nb : real = [1.5, 2.5]\nc : { d : string = \"x\" }\n", doc));
+  REQUIRE(doc.size() == 3);
+  REQUIRE(doc[0].Key == "a");
+  REQUIRE(boost::get<int>(doc[0].Value) == 1);
+  REQUIRE(boost::get<std::vector<double> >(doc[1].Value).size() == 2);
+  const auto& sub = boost::get<warwick::PropertyList>(doc[2].Value);
+  REQUIRE(sub.size() == 1);
+  REQUIRE(boost::get<std::string>(sub[0].Value) == "x");
+}
+
+TEST_CASE("Descriptions are collected into side table") {
+  const std::string text =
+      "@description \"Configures foo\"\n"
+      "foo : int = 42\n"
+      "bar : int = 1\n"
+      "@description \"Baz subtree\" baz : {\n"
+      "  a : int = 1\n"
+      "  b : {\n"
+      "    @description \"Bits of b\"\n"
+      "    alpha : int = 314\n"
+      "  }\n"
+      "}\n"
+      "@description \"After tree\"\n"
+      "qux : bool = true\n";
+
+  SECTION("Descriptions are dropped by default") {
+    warwick::PropertyList doc;
+    REQUIRE(parse_text(text, doc));
+    REQUIRE(doc.size() == 4);
+  }
+
+  SECTION("Descriptions are keyed by path") {
+    warwick::PropertyList doc;
+    warwick::PropertyDescriptions descriptions;
+    REQUIRE(parse_text(text, doc, descriptions));
+    REQUIRE(doc.size() == 4);
+    REQUIRE(descriptions.size() == 4);
+    REQUIRE(descriptions["foo"] == "Configures foo");
+    REQUIRE(descriptions["baz"] == "Baz subtree");
+    REQUIRE(descriptions["baz.b.alpha"] == "Bits of b");
+    REQUIRE(descriptions["qux"] == "After tree");
+    REQUIRE(descriptions.count("bar") == 0);
+  }
+}
+
+namespace {
+bool parse_recovering(const std::string& text,
+                      warwick::PropertyList& output,
+                      warwick::ParseErrorList& errors) {
+  std::istringstream input(text);
+  return parse_document(input, output, errors);
+}
+}
+
+TEST_CASE("Recovering parse reports all errors") {
+  SECTION("Valid input has no errors") {
+    warwick::PropertyList doc;
+    warwick::ParseErrorList errors;
+    REQUIRE(parse_recovering("a : int = 1\nb : { c : int = 2 }\n", doc, errors));
+    REQUIRE(errors.empty());
+    REQUIRE(doc.size() == 2);
+  }
+
+  SECTION("Errors at top level and in subtrees") {
+    const std::string text =
+        "a : int = 1\n"
+        "b : int = x\n"
+        "c : real = 2.5\n"
+        "d : {\n"
+        "  e : int = 1\n"
+        "  f : bool = maybe\n"
+        "  g : { h : int = 3 }\n"
+        "}\n"
+        "  i : string = \"ok\"\n"
+        "j = 4\n"
+        "k : int = 5\n";
+    warwick::PropertyList doc;
+    warwick::ParseErrorList errors;
+    REQUIRE_FALSE(parse_recovering(text, doc, errors));
+
+    REQUIRE(errors.size() == 3);
+    REQUIRE(errors[0].line == 2);
+    REQUIRE(errors[0].column == 11);
+    REQUIRE(errors[1].line == 6);
+    REQUIRE(errors[1].column == 14);
+    REQUIRE(errors[2].line == 10);
+    REQUIRE(errors[2].column == 3);
+
+    REQUIRE(doc.size() == 4);
+    REQUIRE(doc[0].Key == "a");
+    REQUIRE(doc[1].Key == "c");
+    REQUIRE(doc[2].Key == "i");
+    REQUIRE(doc[3].Key == "k");
+  }
+
+  SECTION("Braces in strings and comments do not affect resync") {
+    const std::string text =
+        "a : { b : string = \"}\" # {\n"
+        "  c : int = oops\n"
+        "}\n"
+        "d : int = 1\n";
+    warwick::PropertyList doc;
+    warwick::ParseErrorList errors;
+    REQUIRE_FALSE(parse_recovering(text, doc, errors));
+    REQUIRE(errors.size() == 1);
+    REQUIRE(errors[0].line == 2);
+    REQUIRE(doc.size() == 1);
+    REQUIRE(doc[0].Key == "d");
+  }
+}
+
+TEST_CASE("Line index maps offsets to positions") {
+  const std::string text("ab\ncde\n\nf");
+  warwick::LineIndex index(text);
+
+  SECTION("Queries in any order") {
+    warwick::TextPosition p = index.locate(8);
+    REQUIRE(p.line == 4);
+    REQUIRE(p.column == 1);
+
+    p = index.locate(0);
+    REQUIRE(p.line == 1);
+    REQUIRE(p.column == 1);
+
+    p = index.locate(4);
+    REQUIRE(p.line == 2);
+    REQUIRE(p.column == 2);
+  }
+
+  SECTION("Newlines belong to the line they end") {
+    warwick::TextPosition p = index.locate(2);
+    REQUIRE(p.line == 1);
+    REQUIRE(p.column == 3);
+    p = index.locate(7);
+    REQUIRE(p.line == 3);
+    REQUIRE(p.column == 1);
+  }
+
+  SECTION("Line text") {
+    REQUIRE(index.line_text(5) == "cde");
+    REQUIRE(index.line_text(7) == "");
+    REQUIRE(index.line_text(8) == "f");
+  }
+}
+
+namespace {
+std::string nested_document(std::size_t depth) {
+  std::string text;
+  for (std::size_t i = 0; i < depth; ++i) {
+    text += "t : {\n";
+  }
+  text += "leaf : int = 1\n";
+  text += std::string(depth, '}');
+  text += "\n";
+  return text;
+}
+
+std::string to_string(const warwick::PropertyList& doc) {
+  std::ostringstream os;
+  os << doc;
+  return os.str();
+}
+}
+
+TEST_CASE("Iterative parse matches recursive grammar") {
+  const std::string text =
+      "alpha : int = 1\n"
+      "@description \"ignored\"\n"
+      "bravo : int = [1, 2, 3]\n"
+      "delta : {\n"
+      "  echo : string = [\"a\", \"b\"]\n"
+      "  november : { a : real = 1.5  b : bitset = 0x0F }\n"
+      "  # a comment }\n"
+      "}\n"
+      "golf : bool = true\n";
+
+  warwick::PropertyList recursive;
+  REQUIRE(parse_text(text, recursive));
+
+  warwick::PropertyList iterative;
+  std::istringstream input(text);
+  REQUIRE(parse_document_iterative(input, iterative));
+  REQUIRE(to_string(iterative) == to_string(recursive));
+}
+
+TEST_CASE("Iterative parse of deep nesting") {
+  SECTION("Deep documents parse") {
+    warwick::PropertyList doc;
+    std::istringstream input(nested_document(5000));
+    REQUIRE(parse_document_iterative(input, doc, 5000));
+
+    std::size_t depth(0);
+    const warwick::PropertyList* level = &doc;
+    while (level->size() == 1 && level->front().Key == "t") {
+      level = &boost::get<warwick::PropertyList>(level->front().Value);
+      ++depth;
+    }
+    REQUIRE(depth == 5000);
+    REQUIRE(level->front().Key == "leaf");
+  }
+
+  SECTION("Depth limit is enforced") {
+    warwick::PropertyList doc;
+    std::istringstream input(nested_document(11));
+    REQUIRE_FALSE(parse_document_iterative(input, doc, 10));
+  }
+
+  SECTION("Errors in trees are caught") {
+    warwick::PropertyList doc;
+    std::istringstream missingClose("a : { b : int = 1\n");
+    REQUIRE_FALSE(parse_document_iterative(missingClose, doc));
+    std::istringstream emptyTree("a : { }\n");
+    REQUIRE_FALSE(parse_document_iterative(emptyTree, doc));
+    std::istringstream badValue("a : { b : int = x }\n");
+    REQUIRE_FALSE(parse_document_iterative(badValue, doc));
+  }
+}
+
+TEST_CASE("Quantities are converted to SI units as they are parsed") {
+  warwick::PropertyList doc;
+  REQUIRE(parse_text("width : real as length = 3.14 mm\n"
+                     "gaps : real as length = [1 mm, 0.5 cm,2 m]  # comment\n"
+                     "g : real as acceleration = 9.81 m s^-2\n"
+                     "e : real as energy = 2 GeV\n"
+                     "ratio : real as dimensionless = 0.5\n"
+                     "plain : real = 1.5\n",
+                     doc));
+  REQUIRE(doc.size() == 6);
+  REQUIRE(boost::get<double>(doc[0].Value) == Approx(3.14e-3));
+  const auto& gaps = boost::get<std::vector<double> >(doc[1].Value);
+  REQUIRE(gaps.size() == 3);
+  REQUIRE(gaps[0] == Approx(1e-3));
+  REQUIRE(gaps[1] == Approx(5e-3));
+  REQUIRE(gaps[2] == Approx(2.0));
+  REQUIRE(boost::get<double>(doc[2].Value) == Approx(9.81));
+  REQUIRE(boost::get<double>(doc[3].Value) == Approx(2e9 * 1.602176634e-19));
+  REQUIRE(boost::get<double>(doc[4].Value) == 0.5);
+  REQUIRE(boost::get<double>(doc[5].Value) == 1.5);
+
+  doc.clear();
+  REQUIRE_FALSE(parse_text("width : real as length = 3 s\n", doc));
+  REQUIRE_FALSE(parse_text("width : real as length = 3\n", doc));
+  REQUIRE_FALSE(parse_text("width : real as length = 3 furlong\n", doc));
+  REQUIRE_FALSE(parse_text("width : real as lengths = 3 m\n", doc));
+
+  warwick::ParseErrorList errors;
+  std::istringstream input("width : real as length = [1 mm, 2 kg]\nok : int = 1\n");
+  input.unsetf(std::ios::skipws);
+  REQUIRE_FALSE(parse_document(input, doc, errors));
+  REQUIRE(errors.size() == 1);
+  REQUIRE(errors[0].line == 1);
+  REQUIRE(doc.size() == 1);
+}
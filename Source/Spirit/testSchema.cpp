@@ -0,0 +1,167 @@
+#include "catch.hpp"
+#include "PerfectHash.hpp"
+#include "PropertyParser.hpp"
+#include "Schema.hpp"
+
+#include <sstream>
+
+namespace {
+const std::string cSchema =
+    "name : { type : string = \"string\"  required : bool = true }\n"
+    "channels : { type : string = \"int[]\"  min : int = 0  max : int = 63  size : int = 4 }\n"
+    "mask : { type : string = \"bitset\"  maxsize : int = 8 }\n"
+    "geometry : {\n"
+    "  type : string = \"tree\"\n"
+    "  fields : {\n"
+    "    width : { type : string = \"real\"  min : real = 0  required : bool = true }\n"
+    "    extra : { type : string = \"tree\"  open : bool = true }\n"
+    "  }\n"
+    "}\n";
+
+warwick::Schema make_schema(const std::string& text) {
+  warwick::Schema schema;
+  std::istringstream input(text);
+  std::string error;
+  REQUIRE(schema.read(input, error));
+  return schema;
+}
+
+bool validate(const warwick::Schema& schema,
+              const std::string& text,
+              warwick::ParseErrorList& errors) {
+  std::istringstream input(text);
+  input.unsetf(std::ios::skipws);
+  warwick::PropertyList output;
+  errors.clear();
+  return parse_document(input, output, schema, errors);
+}
+}
+
+TEST_CASE("Perfect hash finds every key and rejects others") {
+  std::vector<warwick::PerfectHash<std::string, int>::entry_type> entries;
+  for (int i = 0; i < 1000; ++i) {
+    entries.emplace_back("key" + std::to_string(i), i);
+  }
+  warwick::PerfectHash<std::string, int> table;
+  REQUIRE(table.build(entries));
+  REQUIRE(table.capacity() >= 1000);
+
+  for (int i = 0; i < 1000; ++i) {
+    const int* v = table.find("key" + std::to_string(i));
+    REQUIRE(v != nullptr);
+    REQUIRE(*v == i);
+  }
+  REQUIRE(table.find("key1000") == nullptr);
+  REQUIRE(table.find("") == nullptr);
+
+  entries.emplace_back("key7", 0);
+  REQUIRE_FALSE(table.build(entries));
+
+  warwick::PerfectHash<std::string, int> empty;
+  REQUIRE(empty.build({}));
+  REQUIRE(empty.find("a") == nullptr);
+}
+
+namespace {
+/// Traits under which keys of the same length collide
+struct LengthTraits {
+  static std::uint64_t hash(boost::string_ref key) {
+    return key.size();
+  }
+
+  static bool equal(const std::string& stored, boost::string_ref key) {
+    return boost::string_ref(stored) == key;
+  }
+};
+}
+
+TEST_CASE("Perfect hash rejects distinct keys with the same hash") {
+  warwick::PerfectHash<std::string, int, LengthTraits> table;
+  REQUIRE(table.build({{"a", 1}, {"bb", 2}, {"ccc", 3}}));
+  REQUIRE(*table.find("bb") == 2);
+  REQUIRE(table.find("dd") == nullptr);
+  REQUIRE_FALSE(table.build({{"a", 1}, {"bb", 2}, {"cc", 3}}));
+}
+
+TEST_CASE("Invalid schemas are rejected") {
+  warwick::Schema schema;
+  std::string error;
+
+  REQUIRE_FALSE(schema.compile({warwick::Property{"a", 1}}, error));
+  REQUIRE(error == "schema for 'a' must be a tree");
+
+  std::istringstream bad("a : { type : string = \"float\" }");
+  REQUIRE_FALSE(schema.read(bad, error));
+  REQUIRE(error == "invalid constraint 'type' for 'a'");
+
+  std::istringstream notype("a : { required : bool = true }");
+  REQUIRE_FALSE(schema.read(notype, error));
+  REQUIRE(error == "no type given for 'a'");
+
+  std::istringstream sized("a : { type : string = \"int\"  size : int = 2 }");
+  REQUIRE_FALSE(schema.read(sized, error));
+
+  std::istringstream dup("a : { type : string = \"int\" }\na : { type : string = \"int\" }");
+  REQUIRE_FALSE(schema.read(dup, error));
+  REQUIRE(error == "duplicate property in schema");
+}
+
+TEST_CASE("Conforming documents validate") {
+  const warwick::Schema schema = make_schema(cSchema);
+  warwick::ParseErrorList errors;
+
+  REQUIRE(validate(schema,
+                   "name : string = \"x\"\n"
+                   "channels : int = [0, 1, 2, 63]\n"
+                   "geometry : {\n"
+                   "  width : real = 1.5\n"
+                   "  extra : { anything : int = 1 }\n"
+                   "}\n",
+                   errors));
+  REQUIRE(errors.empty());
+}
+
+TEST_CASE("Violations are reported in document order") {
+  const warwick::Schema schema = make_schema(cSchema);
+  warwick::ParseErrorList errors;
+
+  REQUIRE_FALSE(validate(schema,
+                         "channels : int = [0, 64, 2, 3]\n"
+                         "mask : bitset = 101010101\n"
+                         "colour : string = \"red\"\n"
+                         "geometry : {\n"
+                         "  width : int = 1\n"
+                         "  depth : real = 2\n"
+                         "}\n"
+                         "geometry : { extra : { a : int = 1 } }\n",
+                         errors));
+  REQUIRE(errors.size() == 7);
+  REQUIRE(errors[0].line == 1);
+  REQUIRE(errors[0].message == "property 'channels' is outside the range [0, 63]");
+  REQUIRE(errors[1].line == 2);
+  REQUIRE(errors[1].message == "property 'mask' has size 9, expected at most 8");
+  REQUIRE(errors[2].message == "unknown property 'colour'");
+  REQUIRE(errors[3].line == 5);
+  REQUIRE(errors[3].column == 3);
+  REQUIRE(errors[3].message == "property 'geometry.width' must be of type real, not int");
+  REQUIRE(errors[4].message == "unknown property 'geometry.depth'");
+  REQUIRE(errors[5].line == 8);
+  REQUIRE(errors[5].message == "missing required property 'geometry.width'");
+  REQUIRE(errors[6].message == "missing required property 'name'");
+}
+
+TEST_CASE("Syntax errors and violations are reported together") {
+  const warwick::Schema schema = make_schema(cSchema);
+  warwick::ParseErrorList errors;
+
+  REQUIRE_FALSE(validate(schema,
+                         "name : int = 1\n"
+                         "channels : int = [1, 2\n"
+                         "geometry : { width : real = -1 }\n",
+                         errors));
+  REQUIRE(errors.size() == 3);
+  REQUIRE(errors[0].message == "property 'name' must be of type string, not int");
+  REQUIRE(errors[1].line == 3);
+  REQUIRE(errors[1].message == "expected \"]\"");
+  REQUIRE(errors[2].message == "property 'geometry.width' is outside the range [0, ]");
+}
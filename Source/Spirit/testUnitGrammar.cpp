@@ -1,6 +1,8 @@
 #include "catch.hpp"
 #include "UnitsGrammar.hpp"
 
+#include <array>
+
 using namespace BoostExamples;
 
 TEST_CASE("Check basic parsing") {
@@ -12,11 +14,14 @@ TEST_CASE("Check basic parsing") {
   std::string basicExponents {"kg^-2"};
   REQUIRE(get_unit_factor(basicExponents.begin(), basicExponents.end(), dummy));
 
-  std::string wsIsSignificant {"mm m"};
+  std::string wsIsSignificant {"k m"};
   REQUIRE_FALSE(get_unit_factor(wsIsSignificant.begin(), wsIsSignificant.end(), dummy));
 
   std::string chompShouldWork {"  m m m     "};
   REQUIRE(get_unit_factor(chompShouldWork.begin(), chompShouldWork.end(), dummy));
+
+  std::string unknownSymbol {"m furlong"};
+  REQUIRE_FALSE(get_unit_factor(unknownSymbol.begin(), unknownSymbol.end(), dummy));
 }
 
 TEST_CASE("Check value synthesis") {
@@ -29,27 +34,130 @@ TEST_CASE("Check value synthesis") {
   }
 
   SECTION("basic symbol synthesis") {
-    std::string meter {"m"};
+    std::string meter {"mm"};
     get_unit_factor(meter.begin(), meter.end(), value);
-    REQUIRE(value == Approx(2.0));
+    REQUIRE(value == Approx(1e-3));
   }
 
   SECTION("symbol synthesis with positive powers") {
-    std::string unit {"m^2"};
+    std::string unit {"cm^2"};
     get_unit_factor(unit.begin(), unit.end(), value);
-    REQUIRE(value == Approx(4.0));
+    REQUIRE(value == Approx(1e-4));
   }
 
   SECTION("symbol synthesis with negative powers") {
-    std::string unit {"m^-2"};
+    std::string unit {"km^-2"};
     get_unit_factor(unit.begin(), unit.end(), value);
-    REQUIRE(value == Approx(0.25));
+    REQUIRE(value == Approx(1e-6));
   }
 
   SECTION("multisymbol synthesis") {
-    std::string unit {"kg m s^-2"};
+    std::string unit {"g mm ms^-2"};
     get_unit_factor(unit.begin(), unit.end(), value);
-    REQUIRE(value == Approx(1.0*2.0*std::pow(3.0,-2)));
+    REQUIRE(value == Approx(1e-3*1e-3*std::pow(1e-3,-2)));
   }
 
+  SECTION("HEP units") {
+    std::string unit {"GeV"};
+    get_unit_factor(unit.begin(), unit.end(), value);
+    REQUIRE(value == Approx(1.602176634e-10));
+
+    std::string area {"fb^-1"};
+    get_unit_factor(area.begin(), area.end(), value);
+    REQUIRE(value == Approx(1e43));
+  }
+
+}
+
+TEST_CASE("Check expressions are memoised") {
+  warwick::units::UnitCache& cache = warwick::units::unit_cache();
+  const auto before = cache.statistics();
+
+  std::string unit {"kg m^2 s^-2 mol^-1"};
+  warwick::units::UnitValue first;
+  REQUIRE(get_unit_value(unit.begin(), unit.end(), first));
+  warwick::units::UnitValue second;
+  REQUIRE(get_unit_value(unit.begin(), unit.end(), second));
+
+  const auto after = cache.statistics();
+  REQUIRE(after.misses == before.misses + 1);
+  REQUIRE(after.hits == before.hits + 1);
+  REQUIRE(after.entries == before.entries + 1);
+  REQUIRE(second.factor == first.factor);
+  REQUIRE(second.dimension == warwick::units::make_dimension(2, 1, -2, 0, 0, -1));
+
+  // Failures are not cached
+  std::string bad {"kg furlong"};
+  REQUIRE_FALSE(get_unit_value(bad.begin(), bad.end(), first));
+  REQUIRE(cache.statistics().entries == after.entries);
+}
+
+TEST_CASE("Check dimensions can be required") {
+  using warwick::units::find_dimension;
+  double factor {0.0};
+
+  std::string length {"mm"};
+  REQUIRE(get_unit_factor(length.begin(), length.end(), find_dimension("length", 6), factor));
+  REQUIRE(factor == Approx(1e-3));
+  REQUIRE_FALSE(get_unit_factor(length.begin(), length.end(), find_dimension("time", 4), factor));
+
+  std::string energy {"kg m^2 s^-2"};
+  warwick::units::UnitValue value;
+  REQUIRE(get_unit_value(energy.begin(), energy.end(), find_dimension("energy", 6), value));
+  REQUIRE(std::string(warwick::units::dimension_name(value.dimension)) == "energy");
+  REQUIRE(warwick::units::dimension_string(value.dimension) == "m^2 kg s^-2");
+
+  std::string tesla {"uT"};
+  REQUIRE(get_unit_value(tesla.begin(), tesla.end(), value));
+  REQUIRE(warwick::units::exponents(value.dimension) ==
+          (std::array<int, 7>{{0, 1, -2, -1, 0, 0, 0}}));
+}
+
+TEST_CASE("Exponents out of range are rejected") {
+  using warwick::units::find_dimension;
+  warwick::units::UnitValue value;
+
+  // Would otherwise carry 256 m into 1 kg
+  std::string overflow {"m^127 m^127 m^2"};
+  REQUIRE_FALSE(get_unit_value(overflow.begin(), overflow.end(), value));
+  REQUIRE_FALSE(get_unit_value(overflow.begin(), overflow.end(), find_dimension("mass", 4), value));
+
+  std::string underflow {"s^-128 s^-1"};
+  REQUIRE_FALSE(get_unit_value(underflow.begin(), underflow.end(), value));
+
+  std::string edge {"m^127 m^-127 m"};
+  REQUIRE(get_unit_value(edge.begin(), edge.end(), find_dimension("length", 6), value));
+}
+
+TEST_CASE("Dimension products match exponent arithmetic") {
+  using namespace warwick::units;
+  // Other base dimensions carry fixed exponents, which must be unaffected
+  const std::array<int, 7> fixed {{3, -2, 1, 0, -1, 2, -3}};
+  auto code = [](std::array<int, 7> e) {
+    return make_dimension(e[0], e[1], e[2], e[3], e[4], e[5], e[6]);
+  };
+
+  for (int b = 0; b < base_dimension_count; ++b) {
+    const base_dimension base = static_cast<base_dimension>(b);
+    for (int x = -128; x < 128; ++x) {
+      std::array<int, 7> ea(fixed);
+      ea[b] = x;
+      const dimension_code a = code(ea);
+      for (int y = -128; y < 128; ++y) {
+        std::array<int, 7> eb {{0, 0, 0, 0, 0, 0, 0}};
+        eb[b] = y;
+        const dimension_code c = code(eb);
+        const dimension_code p = multiply(a, c);
+        const dimension_code q = divide(a, c);
+        const bool pOk = x + y >= -128 && x + y <= 127;
+        const bool qOk = x - y >= -128 && x - y <= 127;
+        ea[b] = x + y;
+        const bool pRight = pOk ? p == code(ea) : !is_valid(p);
+        ea[b] = x - y;
+        const bool qRight = qOk ? q == code(ea) : !is_valid(q);
+        ea[b] = x;
+        if (!pRight || !qRight) FAIL("base " << base << ", exponents " << x << ", " << y);
+      }
+    }
+  }
 }
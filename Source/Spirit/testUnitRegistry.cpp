@@ -0,0 +1,70 @@
+#include "catch.hpp"
+#include "UnitRegistry.hpp"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+TEST_CASE("Registry finds every unit table symbol") {
+  warwick::UnitRegistry registry;
+  REQUIRE(registry.size() == warwick::units::detail::cUnitSymbolCount);
+
+  const warwick::UnitRegistry::unit_id mm = registry.find("mm");
+  REQUIRE(mm != warwick::UnitRegistry::cUnknownUnit);
+  REQUIRE(registry.name(mm) == "mm");
+  REQUIRE(registry.value(mm).factor == Approx(1e-3));
+  REQUIRE(registry.find("keV") != warwick::UnitRegistry::cUnknownUnit);
+  REQUIRE(registry.find("furlong") == warwick::UnitRegistry::cUnknownUnit);
+
+  REQUIRE(registry.factor(mm, registry.find("km")) == Approx(1e-6));
+  REQUIRE(registry.factor(registry.find("MeV"), registry.find("keV")) == Approx(1e3));
+  REQUIRE(std::isnan(registry.factor(mm, registry.find("ns"))));
+}
+
+TEST_CASE("Units can be defined at runtime") {
+  warwick::UnitRegistry registry;
+  const warwick::units::dimension_code length = warwick::units::find_dimension("length", 6);
+  REQUIRE(registry.define({{"foot", {0.3048, length}}, {"inch", {0.0254, length}}}));
+  REQUIRE(registry.factor(registry.find("foot"), registry.find("inch")) == Approx(12.0));
+  REQUIRE(registry.factor(registry.find("foot"), registry.find("m")) == Approx(0.3048));
+
+  const std::size_t size = registry.size();
+  REQUIRE_FALSE(registry.define({{"yard", {0.9144, length}}, {"m", {1.0, length}}}));
+  REQUIRE_FALSE(registry.define({{"yard", {0.9144, length}}, {"yard", {0.9144, length}}}));
+  REQUIRE_FALSE(registry.define({{"bad", {1.0, warwick::units::cInvalidDimension}}}));
+  for (double bad : {0.0, -0.3048, std::numeric_limits<double>::quiet_NaN(),
+                     std::numeric_limits<double>::infinity()}) {
+    REQUIRE_FALSE(registry.define({{"yard", {0.9144, length}}, {"bad", {bad, length}}}));
+  }
+  REQUIRE(registry.size() == size);
+  REQUIRE(registry.find("yard") == warwick::UnitRegistry::cUnknownUnit);
+}
+
+TEST_CASE("Columns are converted in one call") {
+  warwick::UnitRegistry registry;
+  const warwick::UnitRegistry::unit_id mm = registry.find("mm");
+  const warwick::UnitRegistry::unit_id cm = registry.find("cm");
+
+  const std::vector<double> values = {1.0, 2.0, 3.0, 4.0, 5.0};
+  std::vector<double> out(values.size());
+  REQUIRE(registry.convert(values.data(), values.size(), cm, mm, out.data()));
+  REQUIRE(out[4] == Approx(50.0));
+  REQUIRE_FALSE(registry.convert(values.data(), values.size(), cm, registry.find("s"), out.data()));
+
+  const std::vector<std::string> units = {"m", "m", "cm", "s", "nope"};
+  REQUIRE(registry.convert(values.data(), units.data(), units.size(), mm, out.data()) == 2);
+  REQUIRE(out[0] == Approx(1000.0));
+  REQUIRE(out[1] == Approx(2000.0));
+  REQUIRE(out[2] == Approx(30.0));
+  REQUIRE(std::isnan(out[3]));
+  REQUIRE(std::isnan(out[4]));
+
+  const std::vector<warwick::UnitRegistry::unit_id> ids = {
+      cm, mm, warwick::UnitRegistry::cUnknownUnit, cm, registry.find("ns")};
+  REQUIRE(registry.convert(values.data(), ids.data(), ids.size(), mm, out.data()) == 2);
+  REQUIRE(out[0] == Approx(10.0));
+  REQUIRE(out[1] == Approx(2.0));
+  REQUIRE(std::isnan(out[2]));
+  REQUIRE(out[3] == Approx(40.0));
+}
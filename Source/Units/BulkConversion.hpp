@@ -0,0 +1,157 @@
+// BulkConversion - unit conversion of whole arrays of values
+//
+// A Conversion is the affine map out = scale * in + offset. Most units
+// differ only in scale, but temperature-like units also need an offset.
+// Conversions compose with then(), so a chain such as mm -> m -> inch
+// folds into one Conversion before any data is touched, and an array is
+// converted in a single pass whatever the length of the chain.
+//
+// convert() applies a Conversion to a contiguous array of doubles, or of
+// boost::units::quantity<Unit, double>, which has the layout of a double.
+// The loop is a branch free multiply-add over plain pointers, which the
+// compiler vectorises. Arrays of at least cParallelConversionSize values
+// are split into contiguous blocks converted on separate threads.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BULKCONVERSION_HH
+#define BULKCONVERSION_HH
+
+// Standard Library
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Third Party
+// - Boost
+#include "boost/units/conversion.hpp"
+#include "boost/units/quantity.hpp"
+
+// This Project
+#include "UnitTable.hpp"
+
+namespace warwick {
+namespace units {
+/// The affine conversion out = scale * in + offset
+struct Conversion {
+  double scale;
+  double offset;
+};
+
+constexpr Conversion cIdentityConversion = {1.0, 0.0};
+
+/// Degrees Celsius to kelvin, and the reverse
+constexpr Conversion cCelsiusToKelvin = {1.0, 273.15};
+constexpr Conversion cKelvinToCelsius = {1.0, -273.15};
+
+/// The conversion applying a, then b
+constexpr Conversion then(Conversion a, Conversion b) {
+  return {a.scale * b.scale, a.offset * b.scale + b.offset};
+}
+
+/// The conversion undoing c
+constexpr Conversion inverse(Conversion c) {
+  return {1.0 / c.scale, -c.offset / c.scale};
+}
+
+/// Set c to the conversion from values in unit from to values in unit to,
+/// returning false if their dimensions differ
+inline bool make_conversion(const UnitValue& from, const UnitValue& to, Conversion& c) {
+  if (!is_valid(from.dimension) || from.dimension != to.dimension) return false;
+  c = {from.factor / to.factor, 0.0};
+  return true;
+}
+
+/// The conversion between two Boost.Units units
+template <typename From, typename To>
+Conversion make_conversion(From, To) {
+  return {boost::units::conversion_factor(From(), To()), 0.0};
+}
+
+/// Arrays of at least this many values are converted on several threads
+constexpr std::size_t cParallelConversionSize = std::size_t(1) << 18;
+
+namespace detail {
+inline void convert_block(const double* in, double* out, std::size_t n, Conversion c) {
+  const double scale = c.scale;
+  const double offset = c.offset;
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = scale * in[i] + offset;
+  }
+}
+
+template <typename Unit>
+const double* values(const boost::units::quantity<Unit, double>* q) {
+  static_assert(std::is_standard_layout<boost::units::quantity<Unit, double> >::value &&
+                    sizeof(*q) == sizeof(double),
+                "quantity must have the layout of a double");
+  return reinterpret_cast<const double*>(q);
+}
+
+template <typename Unit>
+double* values(boost::units::quantity<Unit, double>* q) {
+  return const_cast<double*>(values(static_cast<const boost::units::quantity<Unit, double>*>(q)));
+}
+} // namespace detail
+
+/// Convert n values from in into out, which may be the same array but
+/// must not otherwise overlap it. Up to threads threads are used for
+/// arrays of at least threshold values, 0 meaning one per core
+inline void convert(const double* in,
+                    double* out,
+                    std::size_t n,
+                    Conversion c,
+                    std::size_t threads = 0,
+                    std::size_t threshold = cParallelConversionSize) {
+  if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+  // Every thread gets at least half a threshold's worth of values
+  threads = std::min(threads, std::max<std::size_t>(1, 2 * n / std::max<std::size_t>(threshold, 2)));
+  if (n < threshold || threads < 2) {
+    detail::convert_block(in, out, n, c);
+    return;
+  }
+
+  // Blocks are multiples of 8 values, so threads share at most a cache
+  // line at each boundary
+  const std::size_t block = ((n + threads - 1) / threads + 7) & ~std::size_t(7);
+  std::vector<std::thread> workers;
+  for (std::size_t first = block; first < n; first += block) {
+    workers.emplace_back(detail::convert_block, in + first, out + first,
+                         std::min(block, n - first), c);
+  }
+  detail::convert_block(in, out, std::min(block, n), c);
+  for (std::thread& t : workers) t.join();
+}
+
+/// Convert n values in place
+inline void convert(double* data, std::size_t n, Conversion c) {
+  convert(data, data, n, c);
+}
+
+/// Convert n quantities between units, e.g. millimetres to metres
+template <typename From, typename To>
+void convert(const boost::units::quantity<From, double>* in,
+             boost::units::quantity<To, double>* out,
+             std::size_t n) {
+  convert(detail::values(in), detail::values(out), n, make_conversion(From(), To()));
+}
+
+/// Convert n quantities with c, e.g. to include an offset
+template <typename From, typename To>
+void convert(const boost::units::quantity<From, double>* in,
+             boost::units::quantity<To, double>* out,
+             std::size_t n,
+             Conversion c) {
+  convert(detail::values(in), detail::values(out), n, c);
+}
+} // namespace units
+} // namespace warwick
+
+#endif // BULKCONVERSION_HH
@@ -0,0 +1,258 @@
+// DynQuantity - quantities whose unit is only known at runtime
+//
+// boost::units checks dimensions at compile time, which is no help when
+// units come from a configuration file or user input. dyn_quantity keeps
+// that checking at runtime, cheaply: it is a value in SI units plus the
+// packed dimension code of UnitDimension.hpp, 16 bytes in all. As each
+// exponent is a biased byte of the code, multiplying or dividing two
+// quantities adds or subtracts the exponents bytewise (range checked, see
+// multiply() and divide()), and adding them compares the codes.
+//
+// Operations between quantities of different dimension, or that take an
+// exponent out of range, do not throw, but give a quantity of
+// cInvalidDimension and NaN value, which propagates like NaN through any
+// further arithmetic. Check is_valid() where the result is used:
+//
+//   dyn_quantity width(2.5, find_unit("mm", 2));  // 0.0025 m
+//   dyn_quantity area = width * width;            // 6.25e-6 m^2
+//   dyn_quantity bad = width + area;              // !bad.is_valid()
+//
+// A static boost::units quantity converts implicitly to a dyn_quantity,
+// and to_quantity() converts back, failing if the dimensions differ.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNQUANTITY_HH
+#define DYNQUANTITY_HH
+
+// Standard Library
+#include <limits>
+
+// Third Party
+// - Boost
+#include "boost/units/conversion.hpp"
+#include "boost/units/dimensionless_type.hpp"
+#include "boost/units/quantity.hpp"
+
+// This Project
+#include "UnitDimension.hpp"
+#include "UnitLiteral.hpp"
+#include "UnitTable.hpp"
+
+namespace warwick {
+namespace units {
+namespace detail {
+/// Index of a boost::units base dimension
+template <typename Base>
+struct base_index;
+
+template <>
+struct base_index<boost::units::length_base_dimension> {
+  static constexpr base_dimension value = length;
+};
+
+template <>
+struct base_index<boost::units::mass_base_dimension> {
+  static constexpr base_dimension value = mass;
+};
+
+template <>
+struct base_index<boost::units::time_base_dimension> {
+  static constexpr base_dimension value = time;
+};
+
+template <>
+struct base_index<boost::units::current_base_dimension> {
+  static constexpr base_dimension value = current;
+};
+
+template <>
+struct base_index<boost::units::temperature_base_dimension> {
+  static constexpr base_dimension value = temperature;
+};
+
+template <>
+struct base_index<boost::units::amount_base_dimension> {
+  static constexpr base_dimension value = amount;
+};
+
+template <>
+struct base_index<boost::units::luminous_intensity_base_dimension> {
+  static constexpr base_dimension value = luminosity;
+};
+
+/// Packed code of a boost::units dimension list
+template <typename Dimension>
+struct dimension_code_of;
+
+template <>
+struct dimension_code_of<boost::units::dimensionless_type> {
+  static constexpr dimension_code value = cDimensionless;
+};
+
+template <typename Base, typename Exponent, typename Next>
+struct dimension_code_of<boost::units::list<boost::units::dim<Base, Exponent>, Next> > {
+  static_assert(Exponent::Denominator == 1, "only integer exponents are supported");
+
+  static constexpr dimension_code value =
+      cDimensionless +
+      (static_cast<dimension_code>(Exponent::Numerator) << (8 * base_index<Base>::value)) +
+      (dimension_code_of<Next>::value - cDimensionless);
+};
+} // namespace detail
+
+/// Packed dimension of the boost::units unit Unit
+template <typename Unit>
+constexpr dimension_code dimension_of() {
+  return detail::dimension_code_of<typename Unit::dimension_type>::value;
+}
+
+class dyn_quantity {
+ public:
+  /// Dimensionless zero
+  constexpr dyn_quantity() : value_(0.0), dimension_(cDimensionless) {}
+
+  /// value in SI units of dimension d
+  constexpr dyn_quantity(double value, dimension_code d)
+      : value_(units::is_valid(d) ? value : std::numeric_limits<double>::quiet_NaN()),
+        dimension_(units::is_valid(d) ? d : cInvalidDimension) {}
+
+  /// value in unit, e.g. find_unit("mm", 2) or "kg m s^-2"_unit
+  constexpr dyn_quantity(double value, const UnitValue& unit)
+      : dyn_quantity(value * unit.factor, unit.dimension) {}
+
+  /// Any boost::units quantity of the SI base dimensions
+  template <typename Unit>
+  dyn_quantity(const boost::units::quantity<Unit, double>& q)
+      : value_(q.value() *
+               boost::units::conversion_factor(Unit(), si_unit<dimension_of<Unit>()>())),
+        dimension_(dimension_of<Unit>()) {}
+
+  /// Value in SI units
+  constexpr double value() const {
+    return value_;
+  }
+
+  constexpr dimension_code dimension() const {
+    return dimension_;
+  }
+
+  constexpr bool is_valid() const {
+    return units::is_valid(dimension_);
+  }
+
+  /// Value in unit, or NaN if its dimension differs
+  constexpr double in(const UnitValue& unit) const {
+    return unit.dimension == dimension_ ? value_ / unit.factor
+                                        : std::numeric_limits<double>::quiet_NaN();
+  }
+
+  dyn_quantity& operator+=(const dyn_quantity& rhs) {
+    *this = dyn_quantity(value_ + rhs.value_, same(rhs));
+    return *this;
+  }
+
+  dyn_quantity& operator-=(const dyn_quantity& rhs) {
+    *this = dyn_quantity(value_ - rhs.value_, same(rhs));
+    return *this;
+  }
+
+  dyn_quantity& operator*=(const dyn_quantity& rhs) {
+    *this = dyn_quantity(value_ * rhs.value_, multiply(dimension_, rhs.dimension_));
+    return *this;
+  }
+
+  dyn_quantity& operator/=(const dyn_quantity& rhs) {
+    *this = dyn_quantity(value_ / rhs.value_, divide(dimension_, rhs.dimension_));
+    return *this;
+  }
+
+  dyn_quantity& operator*=(double rhs) {
+    value_ *= rhs;
+    return *this;
+  }
+
+  dyn_quantity& operator/=(double rhs) {
+    value_ /= rhs;
+    return *this;
+  }
+
+  constexpr dyn_quantity operator-() const {
+    return dyn_quantity(-value_, dimension_);
+  }
+
+ private:
+  /// The common dimension of this and rhs, or cInvalidDimension
+  constexpr dimension_code same(const dyn_quantity& rhs) const {
+    return dimension_ == rhs.dimension_ ? dimension_ : cInvalidDimension;
+  }
+
+ private:
+  double value_;
+  dimension_code dimension_;
+};
+
+inline dyn_quantity operator+(dyn_quantity lhs, const dyn_quantity& rhs) {
+  return lhs += rhs;
+}
+
+inline dyn_quantity operator-(dyn_quantity lhs, const dyn_quantity& rhs) {
+  return lhs -= rhs;
+}
+
+inline dyn_quantity operator*(dyn_quantity lhs, const dyn_quantity& rhs) {
+  return lhs *= rhs;
+}
+
+inline dyn_quantity operator/(dyn_quantity lhs, const dyn_quantity& rhs) {
+  return lhs /= rhs;
+}
+
+inline dyn_quantity operator*(dyn_quantity lhs, double rhs) {
+  return lhs *= rhs;
+}
+
+inline dyn_quantity operator*(double lhs, dyn_quantity rhs) {
+  return rhs *= lhs;
+}
+
+inline dyn_quantity operator/(dyn_quantity lhs, double rhs) {
+  return lhs /= rhs;
+}
+
+/// Quantities compare equal only if their dimensions and values are
+inline bool operator==(const dyn_quantity& lhs, const dyn_quantity& rhs) {
+  return lhs.dimension() == rhs.dimension() && lhs.value() == rhs.value();
+}
+
+inline bool operator!=(const dyn_quantity& lhs, const dyn_quantity& rhs) {
+  return !(lhs == rhs);
+}
+
+/// Ordering is false between quantities of different dimension
+inline bool operator<(const dyn_quantity& lhs, const dyn_quantity& rhs) {
+  return lhs.dimension() == rhs.dimension() && lhs.value() < rhs.value();
+}
+
+/// q to the integer power n
+inline dyn_quantity pow(const dyn_quantity& q, int n) {
+  return dyn_quantity(detail::integer_power(q.value(), n), power(q.dimension(), n));
+}
+
+/// Set q to the value of d, returning false if their dimensions differ
+template <typename Unit>
+bool to_quantity(const dyn_quantity& d, boost::units::quantity<Unit, double>& q) {
+  if (d.dimension() != dimension_of<Unit>()) return false;
+  q = boost::units::quantity<Unit, double>::from_value(
+      d.value() / boost::units::conversion_factor(Unit(), si_unit<dimension_of<Unit>()>()));
+  return true;
+}
+} // namespace units
+} // namespace warwick
+
+#endif // DYNQUANTITY_HH
@@ -0,0 +1,151 @@
+// UnitCache - memoised values of unit expressions
+//
+// Documents hold many quantities but few distinct unit expressions, so
+// the units grammar remembers the value (factor and dimension) of every
+// expression it has parsed. A repeated expression then costs one hash
+// lookup rather than a parse and a product of powers.
+//
+// The cache is safe to use from many threads. Entries are spread over
+// shards by hash, each with its own reader/writer lock and hit/miss
+// counters, so concurrent lookups of different, or the same, expressions
+// rarely wait or share a cache line. Lookups take a boost::string_ref and
+// hash it once, so a hit allocates nothing. Each shard holds a bounded
+// number of entries; once full, new expressions are simply not
+// remembered. Only successful parses are cached.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef UNITCACHE_HH
+#define UNITCACHE_HH
+
+// Standard Library
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+// Third Party
+// - Boost
+#include "boost/utility/string_ref.hpp"
+
+// This Project
+#include "UnitTable.hpp"
+
+namespace warwick {
+namespace units {
+class UnitCache {
+ public:
+  struct Statistics {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::size_t entries;
+
+    double hit_rate() const {
+      return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    }
+  };
+
+  static const std::size_t cShards = 16;
+
+ public:
+  /// Cache of at most shardEntries expressions per shard
+  explicit UnitCache(std::size_t shardEntries = 1024) : shardEntries_(shardEntries) {}
+
+  UnitCache(const UnitCache&) = delete;
+  UnitCache& operator=(const UnitCache&) = delete;
+
+  /// If expression is cached, set value and return true
+  bool find(boost::string_ref expression, UnitValue& value) {
+    const std::uint64_t h = hash(expression);
+    Shard& shard = shards_[h % cShards];
+    {
+      std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+      auto found = shard.values.find(h);
+      if (found != shard.values.end() && found->second.expression == expression) {
+        value = found->second.value;
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  /// Remember value for expression, if there is room. An expression whose
+  /// hash is already taken by another is not remembered
+  void insert(boost::string_ref expression, const UnitValue& value) {
+    const std::uint64_t h = hash(expression);
+    Shard& shard = shards_[h % cShards];
+    std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+    if (shard.values.size() < shardEntries_) {
+      shard.values.emplace(h, Entry{expression.to_string(), value});
+    }
+  }
+
+  void clear() {
+    for (Shard& shard : shards_) {
+      std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+      shard.values.clear();
+      shard.hits = 0;
+      shard.misses = 0;
+    }
+  }
+
+  Statistics statistics() const {
+    Statistics s{0, 0, 0};
+    for (const Shard& shard : shards_) {
+      std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+      s.hits += shard.hits.load(std::memory_order_relaxed);
+      s.misses += shard.misses.load(std::memory_order_relaxed);
+      s.entries += shard.values.size();
+    }
+    return s;
+  }
+
+ private:
+  struct Entry {
+    std::string expression;
+    UnitValue value;
+  };
+
+  /// Keys are already hashes
+  struct IdentityHash {
+    std::size_t operator()(std::uint64_t h) const {
+      return static_cast<std::size_t>(h);
+    }
+  };
+
+  /// Aligned so threads counting in different shards never share a line
+  struct alignas(64) Shard {
+    mutable std::shared_timed_mutex mutex;
+    std::unordered_map<std::uint64_t, Entry, IdentityHash> values;
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+  };
+
+  static std::uint64_t hash(boost::string_ref expression) {
+    return detail::hash_symbol(expression.data(), expression.size());
+  }
+
+ private:
+  std::size_t shardEntries_;
+  Shard shards_[cShards];
+};
+
+/// The cache used by the units grammar
+inline UnitCache& unit_cache() {
+  static UnitCache cache;
+  return cache;
+}
+} // namespace units
+} // namespace warwick
+
+#endif // UNITCACHE_HH
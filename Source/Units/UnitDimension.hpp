@@ -0,0 +1,222 @@
+// UnitDimension - physical dimensions packed into one integer
+//
+// A dimension is the vector of exponents of the seven SI base dimensions
+// (length, mass, time, current, temperature, amount, luminosity). Each
+// exponent is stored in one byte, biased by 128 so that it is never
+// negative, and the seven bytes are packed into the low 56 bits of a
+// dimension_code:
+//
+//   bits  0- 7 length  8-15 mass  16-23 time  24-31 current
+//   bits 32-39 temperature  40-47 amount  48-55 luminosity
+//
+// Because of the bias, the product of two dimensions is a bytewise
+// addition of the codes, and their quotient a subtraction. An exponent
+// leaving [-128, 127] would carry into its neighbour, so every byte is
+// range checked (in one go, see multiply()) and such a result is
+// cInvalidDimension. Everything here but dimension_string() is
+// constexpr, so codes can be template arguments.
+//
+// Common derived dimensions also have names ("length", "energy", ...),
+// as used to declare the dimension of a quantity in a document.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef UNITDIMENSION_HH
+#define UNITDIMENSION_HH
+
+// Standard Library
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace warwick {
+namespace units {
+typedef std::uint64_t dimension_code;
+
+enum base_dimension {
+  length = 0,
+  mass,
+  time,
+  current,
+  temperature,
+  amount,
+  luminosity,
+  base_dimension_count
+};
+
+/// Code of a dimensionless quantity, every exponent zero
+constexpr dimension_code cDimensionless = 0x0080808080808080ULL;
+
+/// Code marking an invalid unit, e.g. one that failed to parse. Its top
+/// byte, unused by valid codes, is set.
+constexpr dimension_code cInvalidDimension = 0xff00000000000000ULL;
+
+constexpr bool is_valid(dimension_code d) {
+  return (d & cInvalidDimension) == 0;
+}
+
+constexpr dimension_code make_dimension(int lengthExp = 0,
+                                        int massExp = 0,
+                                        int timeExp = 0,
+                                        int currentExp = 0,
+                                        int temperatureExp = 0,
+                                        int amountExp = 0,
+                                        int luminosityExp = 0) {
+  return static_cast<dimension_code>(lengthExp + 128) |
+         static_cast<dimension_code>(massExp + 128) << 8 |
+         static_cast<dimension_code>(timeExp + 128) << 16 |
+         static_cast<dimension_code>(currentExp + 128) << 24 |
+         static_cast<dimension_code>(temperatureExp + 128) << 32 |
+         static_cast<dimension_code>(amountExp + 128) << 40 |
+         static_cast<dimension_code>(luminosityExp + 128) << 48;
+}
+
+/// Exponent of base in d
+constexpr int exponent(dimension_code d, base_dimension base) {
+  return static_cast<int>((d >> (8 * base)) & 0xff) - 128;
+}
+
+namespace detail {
+// Exponents are combined in 16 bit lanes, the even bytes of the codes in
+// one word and the odd ones in another, with the bias adjusted so that a
+// result in range is exactly a lane whose high byte is 1. Lanes cannot
+// carry or borrow into each other, so one check covers every exponent.
+constexpr std::uint64_t cEvenLanes = 0x00ff00ff00ff00ffULL;  // bytes 0, 2, 4, 6
+constexpr std::uint64_t cOddLanes = 0x000000ff00ff00ffULL;   // bytes 1, 3, 5
+constexpr std::uint64_t cLaneHigh = 0xff00ff00ff00ff00ULL;
+
+constexpr dimension_code from_lanes(std::uint64_t even, std::uint64_t odd) {
+  return (even & cLaneHigh) == 0x0100010001000100ULL &&
+                 (odd & cLaneHigh) == 0x0000010001000100ULL
+             ? (even & cEvenLanes) | (odd & cOddLanes) << 8
+             : cInvalidDimension;
+}
+} // namespace detail
+
+/// Product of dimensions, or cInvalidDimension if an exponent leaves
+/// [-128, 127]. Each lane holds x + y + 128 for biased exponents x, y
+constexpr dimension_code multiply(dimension_code a, dimension_code b) {
+  return is_valid(a) && is_valid(b)
+             ? detail::from_lanes(
+                   (a & detail::cEvenLanes) + (b & detail::cEvenLanes) + 0x0080008000800080ULL,
+                   (a >> 8 & detail::cOddLanes) + (b >> 8 & detail::cOddLanes) +
+                       0x0000008000800080ULL)
+             : cInvalidDimension;
+}
+
+/// Quotient of dimensions, or cInvalidDimension if an exponent leaves
+/// [-128, 127]. Each lane holds x - y + 384, which is never negative
+constexpr dimension_code divide(dimension_code a, dimension_code b) {
+  return is_valid(a) && is_valid(b)
+             ? detail::from_lanes(
+                   (a & detail::cEvenLanes) + 0x0180018001800180ULL - (b & detail::cEvenLanes),
+                   (a >> 8 & detail::cOddLanes) + 0x0000018001800180ULL -
+                       (b >> 8 & detail::cOddLanes))
+             : cInvalidDimension;
+}
+
+/// The exponents of d, indexed by base_dimension
+constexpr std::array<int, base_dimension_count> exponents(dimension_code d) {
+  return {{exponent(d, length), exponent(d, mass), exponent(d, time), exponent(d, current),
+           exponent(d, temperature), exponent(d, amount), exponent(d, luminosity)}};
+}
+
+/// d raised to the integer power n
+constexpr dimension_code power(dimension_code d, int n) {
+  if (!is_valid(d)) return cInvalidDimension;
+  dimension_code result(0);
+  for (int b = 0; b < base_dimension_count; ++b) {
+    const int e = exponent(d, static_cast<base_dimension>(b)) * n;
+    if (e < -128 || e > 127) return cInvalidDimension;
+    result |= static_cast<dimension_code>(e + 128) << (8 * b);
+  }
+  return result;
+}
+
+struct DimensionName {
+  const char* name;
+  dimension_code dimension;
+};
+
+/// Named dimensions. Where several names share a dimension, the first
+/// is used by dimension_name().
+constexpr DimensionName cDimensionNames[] = {
+    {"dimensionless", cDimensionless},
+    {"length", make_dimension(1)},
+    {"mass", make_dimension(0, 1)},
+    {"time", make_dimension(0, 0, 1)},
+    {"current", make_dimension(0, 0, 0, 1)},
+    {"temperature", make_dimension(0, 0, 0, 0, 1)},
+    {"amount", make_dimension(0, 0, 0, 0, 0, 1)},
+    {"luminosity", make_dimension(0, 0, 0, 0, 0, 0, 1)},
+    {"area", make_dimension(2)},
+    {"volume", make_dimension(3)},
+    {"frequency", make_dimension(0, 0, -1)},
+    {"velocity", make_dimension(1, 0, -1)},
+    {"acceleration", make_dimension(1, 0, -2)},
+    {"momentum", make_dimension(1, 1, -1)},
+    {"force", make_dimension(1, 1, -2)},
+    {"pressure", make_dimension(-1, 1, -2)},
+    {"energy", make_dimension(2, 1, -2)},
+    {"power", make_dimension(2, 1, -3)},
+    {"density", make_dimension(-3, 1)},
+    {"charge", make_dimension(0, 0, 1, 1)},
+    {"voltage", make_dimension(2, 1, -3, -1)},
+    {"resistance", make_dimension(2, 1, -3, -2)},
+    {"capacitance", make_dimension(-2, -1, 4, 2)},
+    {"inductance", make_dimension(2, 1, -2, -2)},
+    {"magnetic_flux", make_dimension(2, 1, -2, -1)},
+    {"magnetic_field", make_dimension(0, 1, -2, -1)},
+    {"cross_section", make_dimension(2)},
+};
+
+namespace detail {
+constexpr bool name_equal(const char* name, const char* s, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (name[i] != s[i]) return false;
+  }
+  return name[n] == '\0';
+}
+} // namespace detail
+
+/// The dimension called s[0, n), or cInvalidDimension if none is
+constexpr dimension_code find_dimension(const char* s, std::size_t n) {
+  for (const DimensionName& d : cDimensionNames) {
+    if (detail::name_equal(d.name, s, n)) return d.dimension;
+  }
+  return cInvalidDimension;
+}
+
+/// The name of d, or nullptr if it has none
+constexpr const char* dimension_name(dimension_code d) {
+  for (const DimensionName& n : cDimensionNames) {
+    if (n.dimension == d) return n.name;
+  }
+  return nullptr;
+}
+
+/// d as a product of SI base units, e.g. "m kg s^-2", or its name if
+/// it has no exponents
+inline std::string dimension_string(dimension_code d) {
+  static const char* const cBaseUnits[] = {"m", "kg", "s", "A", "K", "mol", "cd"};
+  if (!is_valid(d)) return "invalid";
+  std::string result;
+  for (int b = 0; b < base_dimension_count; ++b) {
+    const int e = exponent(d, static_cast<base_dimension>(b));
+    if (!e) continue;
+    if (!result.empty()) result += ' ';
+    result += cBaseUnits[b];
+    if (e != 1) result += '^' + std::to_string(e);
+  }
+  return result.empty() ? "dimensionless" : result;
+}
+} // namespace units
+} // namespace warwick
+
+#endif // UNITDIMENSION_HH
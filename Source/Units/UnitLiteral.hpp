@@ -0,0 +1,168 @@
+// UnitLiteral - unit expressions parsed at compile time
+//
+// parse_unit() is a constexpr version of the runtime units grammar
+// (Spirit/UnitsGrammar.hpp): whitespace separated unit symbols from
+// UnitTable.hpp, each with an optional integer exponent, such as
+// "kg m s^-2" or "GeV ns^-1". It yields the factor to SI and the packed
+// dimension (UnitDimension.hpp), and si_unit<> turns the dimension into
+// the matching boost::units SI unit type. Unit expressions written in code therefore cost nothing at
+// runtime, and the compiler checks their dimensions:
+//
+//   typedef WARWICK_UNIT("kg m s^-2") force_unit;  // == si::force
+//   constexpr auto width = WARWICK_QUANTITY(2.5, "mm");
+//   // quantity<si::length>, holding 0.0025
+//
+// An expression that does not parse is a compile time error when used
+// as a type. The "..."_unit literal gives the UnitValue itself.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef UNITLITERAL_HH
+#define UNITLITERAL_HH
+
+// Standard Library
+#include <cstddef>
+
+// Third Party
+// - Boost
+#include "boost/mpl/times.hpp"
+#include "boost/units/physical_dimensions.hpp"
+#include "boost/units/quantity.hpp"
+#include "boost/units/static_rational.hpp"
+#include "boost/units/systems/si.hpp"
+
+// This Project
+#include "UnitDimension.hpp"
+#include "UnitTable.hpp"
+
+namespace warwick {
+namespace units {
+namespace detail {
+constexpr bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+constexpr double integer_power(double x, int n) {
+  double result(1.0);
+  for (int i = 0; i < (n < 0 ? -n : n); ++i) result *= x;
+  return n < 0 ? 1.0 / result : result;
+}
+
+/// Base dimension to the integer power E as a boost::units dimension
+template <typename Base, long E>
+struct base_power {
+  typedef typename boost::units::static_power<typename Base::dimension_type,
+                                              boost::units::static_rational<E> >::type type;
+};
+
+template <typename Base>
+struct base_power<Base, 0> {
+  typedef boost::units::dimensionless_type type;
+};
+
+template <dimension_code D, base_dimension B, typename Base>
+struct exponent_of : base_power<Base, exponent(D, B)> {};
+
+template <dimension_code D>
+struct si_unit_impl {
+  static_assert(is_valid(D), "invalid unit expression");
+
+  template <typename A, typename B>
+  using times = typename boost::mpl::times<A, B>::type;
+
+  typedef times<
+      times<times<times<times<times<typename exponent_of<D, length,
+                                                         boost::units::length_base_dimension>::type,
+                                    typename exponent_of<D, mass,
+                                                         boost::units::mass_base_dimension>::type>,
+                              typename exponent_of<D, time,
+                                                   boost::units::time_base_dimension>::type>,
+                        typename exponent_of<D, current,
+                                             boost::units::current_base_dimension>::type>,
+                  typename exponent_of<D, temperature,
+                                       boost::units::temperature_base_dimension>::type>,
+            typename exponent_of<D, amount, boost::units::amount_base_dimension>::type>,
+      typename exponent_of<D, luminosity,
+                           boost::units::luminous_intensity_base_dimension>::type>
+      dimension_type;
+
+  typedef boost::units::unit<dimension_type, boost::units::si::system> type;
+};
+} // namespace detail
+
+/// Parse the unit expression s[0, n). On failure the dimension is
+/// cInvalidDimension.
+constexpr UnitValue parse_unit(const char* s, std::size_t n) {
+  const UnitValue invalid{0.0, cInvalidDimension};
+  UnitValue result{1.0, cDimensionless};
+  std::size_t i(0);
+  while (i < n && detail::is_space(s[i])) ++i;
+  if (i == n) return invalid;
+
+  while (i < n) {
+    const std::size_t first = i;
+    while (i < n && s[i] != '^' && !detail::is_space(s[i])) ++i;
+    const UnitValue symbol = find_unit(s + first, i - first);
+    if (!is_valid(symbol.dimension)) return invalid;
+
+    int e(1);
+    if (i < n && s[i] == '^') {
+      ++i;
+      const bool negative = i < n && s[i] == '-';
+      if (i < n && (s[i] == '-' || s[i] == '+')) ++i;
+      if (i == n || s[i] < '0' || s[i] > '9') return invalid;
+      e = 0;
+      while (i < n && s[i] >= '0' && s[i] <= '9') {
+        e = 10 * e + (s[i++] - '0');
+        if (e > 128) return invalid;
+      }
+      if (negative) e = -e;
+      if (e > 127) return invalid;
+    }
+    result.factor *= detail::integer_power(symbol.factor, e);
+    result.dimension = multiply(result.dimension, power(symbol.dimension, e));
+
+    // Symbols are separated by whitespace, which may also trail
+    if (i < n && !detail::is_space(s[i])) return invalid;
+    while (i < n && detail::is_space(s[i])) ++i;
+  }
+  return result;
+}
+
+template <std::size_t N>
+constexpr UnitValue parse_unit(const char (&s)[N]) {
+  return parse_unit(s, N - 1);
+}
+
+/// The boost::units SI unit of dimension D
+template <dimension_code D>
+using si_unit = typename detail::si_unit_impl<D>::type;
+
+/// An SI quantity of dimension D holding value, already in SI units
+template <dimension_code D>
+constexpr boost::units::quantity<si_unit<D> > make_quantity(double value) {
+  return boost::units::quantity<si_unit<D> >::from_value(value);
+}
+
+namespace literals {
+constexpr UnitValue operator"" _unit(const char* s, std::size_t n) {
+  return parse_unit(s, n);
+}
+} // namespace literals
+} // namespace units
+} // namespace warwick
+
+/// The boost::units SI unit type of the unit expression text
+#define WARWICK_UNIT(text) ::warwick::units::si_unit< ::warwick::units::parse_unit(text).dimension>
+
+/// The quantity value in units of the expression text, converted to SI
+#define WARWICK_QUANTITY(value, text)                                            \
+  ::warwick::units::make_quantity< ::warwick::units::parse_unit(text).dimension>( \
+      (value) * ::warwick::units::parse_unit(text).factor)
+
+#endif // UNITLITERAL_HH
@@ -0,0 +1,261 @@
+// UnitTable - the unit symbols known to the unit parsers
+//
+// Every symbol is generated at compile time from two tables: the units
+// below, and the SI prefixes, which apply to the units marked
+// prefixable. So "mm", "kg", "GeV", "fb" and "uT" all exist without
+// being listed. The SI base and derived units, the litre and the common
+// non-SI units of time and angle, and the electronvolt, barn and gauss
+// are included. Factors convert to SI (so 1 kg, not 1 g, is the unit of
+// mass); the micro prefix is written "u".
+//
+// The generated symbols are stored in a constexpr open addressing hash
+// table (cUnitIndex). find_unit() hashes the symbol and compares it with
+// the entries it probes, so a lookup costs O(symbol length) at runtime
+// and nothing has to be built during static initialisation. Generation
+// fails to compile if two symbols would collide.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef UNITTABLE_HH
+#define UNITTABLE_HH
+
+// Standard Library
+#include <cstddef>
+#include <cstdint>
+
+// This Project
+#include "UnitDimension.hpp"
+
+namespace warwick {
+namespace units {
+/// Factor to SI and dimension of a unit or unit expression
+struct UnitValue {
+  double factor;
+  dimension_code dimension;
+};
+
+/// A unit, worth scale * 10^exponent of the SI unit of its dimension
+struct UnitDefinition {
+  const char* symbol;
+  double scale;
+  int exponent;
+  dimension_code dimension;
+  bool prefixable;
+};
+
+struct UnitPrefix {
+  const char* symbol;
+  int exponent;
+};
+
+namespace detail {
+constexpr dimension_code cArea = make_dimension(2);
+constexpr dimension_code cEnergy = make_dimension(2, 1, -2);
+constexpr dimension_code cCharge = make_dimension(0, 0, 1, 1);
+constexpr dimension_code cVoltage = make_dimension(2, 1, -3, -1);
+constexpr dimension_code cFlux = make_dimension(2, 1, -2, -1);
+constexpr dimension_code cFluxDensity = make_dimension(0, 1, -2, -1);
+} // namespace detail
+
+constexpr UnitDefinition cUnitDefinitions[] = {
+    // SI base units, with the gram standing in for the kilogram
+    {"m", 1.0, 0, make_dimension(1), true},
+    {"g", 1.0, -3, make_dimension(0, 1), true},
+    {"s", 1.0, 0, make_dimension(0, 0, 1), true},
+    {"A", 1.0, 0, make_dimension(0, 0, 0, 1), true},
+    {"K", 1.0, 0, make_dimension(0, 0, 0, 0, 1), true},
+    {"mol", 1.0, 0, make_dimension(0, 0, 0, 0, 0, 1), true},
+    {"cd", 1.0, 0, make_dimension(0, 0, 0, 0, 0, 0, 1), true},
+    // SI derived units
+    {"rad", 1.0, 0, cDimensionless, true},
+    {"sr", 1.0, 0, cDimensionless, true},
+    {"Hz", 1.0, 0, make_dimension(0, 0, -1), true},
+    {"N", 1.0, 0, make_dimension(1, 1, -2), true},
+    {"Pa", 1.0, 0, make_dimension(-1, 1, -2), true},
+    {"J", 1.0, 0, detail::cEnergy, true},
+    {"W", 1.0, 0, make_dimension(2, 1, -3), true},
+    {"C", 1.0, 0, detail::cCharge, true},
+    {"V", 1.0, 0, detail::cVoltage, true},
+    {"F", 1.0, 0, make_dimension(-2, -1, 4, 2), true},
+    {"Ohm", 1.0, 0, make_dimension(2, 1, -3, -2), true},
+    {"S", 1.0, 0, make_dimension(-2, -1, 3, 2), true},
+    {"Wb", 1.0, 0, detail::cFlux, true},
+    {"T", 1.0, 0, detail::cFluxDensity, true},
+    {"H", 1.0, 0, make_dimension(2, 1, -2, -2), true},
+    {"lm", 1.0, 0, make_dimension(0, 0, 0, 0, 0, 0, 1), true},
+    {"lx", 1.0, 0, make_dimension(-2, 0, 0, 0, 0, 0, 1), true},
+    {"Bq", 1.0, 0, make_dimension(0, 0, -1), true},
+    {"Gy", 1.0, 0, make_dimension(2, 0, -2), true},
+    {"Sv", 1.0, 0, make_dimension(2, 0, -2), true},
+    {"kat", 1.0, 0, make_dimension(0, 0, -1, 0, 0, 1), true},
+    // Accepted for use with the SI
+    {"L", 1.0, -3, make_dimension(3), true},
+    {"min", 60.0, 0, make_dimension(0, 0, 1), false},
+    {"h", 3600.0, 0, make_dimension(0, 0, 1), false},
+    {"day", 86400.0, 0, make_dimension(0, 0, 1), false},
+    {"yr", 3.15576, 7, make_dimension(0, 0, 1), false},
+    {"deg", 1.745329251994329577, -2, cDimensionless, false},
+    // High energy physics
+    {"eV", 1.602176634, -19, detail::cEnergy, true},
+    {"b", 1.0, -28, detail::cArea, true},
+    {"G", 1.0, -4, detail::cFluxDensity, false},
+    {"e", 1.602176634, -19, detail::cCharge, false},
+};
+
+constexpr UnitPrefix cUnitPrefixes[] = {
+    {"Y", 24}, {"Z", 21}, {"E", 18}, {"P", 15}, {"T", 12}, {"G", 9},  {"M", 6},
+    {"k", 3},  {"h", 2},  {"da", 1}, {"d", -1}, {"c", -2}, {"m", -3}, {"u", -6},
+    {"n", -9}, {"p", -12}, {"f", -15}, {"a", -18}, {"z", -21}, {"y", -24},
+};
+
+namespace detail {
+constexpr std::size_t cUnitDefinitionCount = sizeof(cUnitDefinitions) / sizeof(UnitDefinition);
+constexpr std::size_t cUnitPrefixCount = sizeof(cUnitPrefixes) / sizeof(UnitPrefix);
+constexpr std::uint8_t cNoPrefix = 0xff;
+
+constexpr std::size_t count_symbols() {
+  std::size_t n(0);
+  for (const UnitDefinition& u : cUnitDefinitions) n += u.prefixable ? 1 + cUnitPrefixCount : 1;
+  return n;
+}
+
+constexpr std::size_t cUnitSymbolCount = count_symbols();
+
+/// Smallest power of two at least twice the number of symbols
+constexpr std::size_t slot_count() {
+  std::size_t n(1);
+  while (n < 2 * cUnitSymbolCount) n *= 2;
+  return n;
+}
+
+constexpr std::size_t cUnitSlotCount = slot_count();
+
+constexpr std::uint64_t hash_step(std::uint64_t h, char c) {
+  return (h ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+}
+
+constexpr std::uint64_t hash_string(std::uint64_t h, const char* s) {
+  while (*s) h = hash_step(h, *s++);
+  return h;
+}
+
+/// FNV-1a of s[0, n)
+constexpr std::uint64_t hash_symbol(const char* s, std::size_t n) {
+  std::uint64_t h(14695981039346656037ULL);
+  for (std::size_t i = 0; i < n; ++i) h = hash_step(h, s[i]);
+  return h;
+}
+
+/// Exact powers of ten up to 10^22, and correctly rounded inverses
+constexpr double power_of_ten(int e) {
+  double p(1.0);
+  for (int i = 0; i < (e < 0 ? -e : e) && i < 22; ++i) p *= 10.0;
+  for (int i = 22; i < (e < 0 ? -e : e); ++i) p *= 10.0;
+  return e < 0 ? 1.0 / p : p;
+}
+
+/// A generated symbol: an optional prefix and a unit
+struct UnitSymbol {
+  std::uint8_t prefix;
+  std::uint8_t unit;
+};
+
+struct UnitIndex {
+  UnitSymbol symbols[cUnitSymbolCount];
+  // Index + 1 of the symbol in each slot, 0 when empty
+  std::uint16_t slots[cUnitSlotCount];
+  bool unique;
+};
+
+constexpr bool symbol_equal(const UnitSymbol& u, const char* s, std::size_t n) {
+  const char* parts[2] = {u.prefix == cNoPrefix ? "" : cUnitPrefixes[u.prefix].symbol,
+                          cUnitDefinitions[u.unit].symbol};
+  std::size_t i(0);
+  for (const char* p : parts) {
+    for (; *p; ++p, ++i) {
+      if (i == n || s[i] != *p) return false;
+    }
+  }
+  return i == n;
+}
+
+constexpr std::uint64_t symbol_hash(const UnitSymbol& u) {
+  return hash_string(
+      hash_string(14695981039346656037ULL,
+                  u.prefix == cNoPrefix ? "" : cUnitPrefixes[u.prefix].symbol),
+      cUnitDefinitions[u.unit].symbol);
+}
+
+/// Length of the generated symbol u
+constexpr std::size_t symbol_length(const UnitSymbol& u) {
+  std::size_t n(0);
+  for (const char* p = cUnitDefinitions[u.unit].symbol; *p; ++p) ++n;
+  if (u.prefix != cNoPrefix) {
+    for (const char* p = cUnitPrefixes[u.prefix].symbol; *p; ++p) ++n;
+  }
+  return n;
+}
+
+/// Write the symbol u to out, which must be large enough
+constexpr void symbol_text(const UnitSymbol& u, char* out) {
+  if (u.prefix != cNoPrefix) {
+    for (const char* p = cUnitPrefixes[u.prefix].symbol; *p; ++p) *out++ = *p;
+  }
+  for (const char* p = cUnitDefinitions[u.unit].symbol; *p; ++p) *out++ = *p;
+}
+
+constexpr UnitIndex make_unit_index() {
+  UnitIndex index{};
+  index.unique = true;
+  std::size_t n(0);
+  for (std::size_t u = 0; u < cUnitDefinitionCount; ++u) {
+    index.symbols[n++] = UnitSymbol{cNoPrefix, static_cast<std::uint8_t>(u)};
+    if (!cUnitDefinitions[u].prefixable) continue;
+    for (std::size_t p = 0; p < cUnitPrefixCount; ++p) {
+      index.symbols[n++] = UnitSymbol{static_cast<std::uint8_t>(p), static_cast<std::uint8_t>(u)};
+    }
+  }
+
+  for (std::size_t i = 0; i < cUnitSymbolCount; ++i) {
+    char text[16] = {};
+    symbol_text(index.symbols[i], text);
+    const std::size_t length = symbol_length(index.symbols[i]);
+    std::size_t slot = symbol_hash(index.symbols[i]) & (cUnitSlotCount - 1);
+    while (index.slots[slot]) {
+      if (symbol_equal(index.symbols[index.slots[slot] - 1], text, length)) index.unique = false;
+      slot = (slot + 1) & (cUnitSlotCount - 1);
+    }
+    index.slots[slot] = static_cast<std::uint16_t>(i + 1);
+  }
+  return index;
+}
+} // namespace detail
+
+constexpr detail::UnitIndex cUnitIndex = detail::make_unit_index();
+static_assert(cUnitIndex.unique, "unit symbols must be unique");
+
+/// Value of the unit symbol s[0, n), with dimension cInvalidDimension if
+/// there is no such symbol
+constexpr UnitValue find_unit(const char* s, std::size_t n) {
+  std::size_t slot = detail::hash_symbol(s, n) & (detail::cUnitSlotCount - 1);
+  while (std::uint16_t entry = cUnitIndex.slots[slot]) {
+    const detail::UnitSymbol& u = cUnitIndex.symbols[entry - 1];
+    if (detail::symbol_equal(u, s, n)) {
+      const UnitDefinition& d = cUnitDefinitions[u.unit];
+      const int e = d.exponent + (u.prefix == detail::cNoPrefix ? 0
+                                                                : cUnitPrefixes[u.prefix].exponent);
+      return UnitValue{d.scale * detail::power_of_ten(e), d.dimension};
+    }
+    slot = (slot + 1) & (detail::cUnitSlotCount - 1);
+  }
+  return UnitValue{0.0, cInvalidDimension};
+}
+} // namespace units
+} // namespace warwick
+
+#endif // UNITTABLE_HH
@@ -0,0 +1,118 @@
+// bulk_conversion - converting large arrays of dimensioned values
+//
+// Times the conversion of a calibration-table sized array of lengths in
+// millimetres to metres: element by element, looking up the unit each
+// time or through Boost.Units quantity conversion, then in bulk with
+// BulkConversion.hpp on one thread and on all cores. A chained
+// conversion with an offset (Celsius to Fahrenheit via kelvin) is timed
+// last.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Standard Library
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Third Party
+// - Boost
+#include "boost/units/systems/si/length.hpp"
+#include "boost/units/make_scaled_unit.hpp"
+
+// This Project
+#include "BulkConversion.hpp"
+
+namespace {
+typedef boost::units::make_scaled_unit<
+    boost::units::si::length,
+    boost::units::scale<10, boost::units::static_rational<-3> > >::type millimetre;
+typedef boost::units::quantity<millimetre> millimetres;
+typedef boost::units::quantity<boost::units::si::length> metres;
+
+template <typename F>
+double time_ms(F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void report(const char* what, double ms, std::size_t n) {
+  std::cout << what << " : " << ms << " ms (" << 1e6 * ms / n << " ns/value)" << std::endl;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  using namespace warwick::units;
+  const std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1u << 24;
+  if (n == 0) {
+    std::cerr << "usage: " << argv[0] << " [number of values > 0]" << std::endl;
+    return 1;
+  }
+  const std::string unit("mm");
+
+  std::vector<double> in(n), out(n), expected(n);
+  std::vector<millimetres> qin(n);
+  std::vector<metres> qout(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    in[i] = 0.001 * static_cast<double>(i % 100000);
+    expected[i] = in[i] * 1e-3;
+    qin[i] = millimetres::from_value(in[i]);
+  }
+
+  std::cout << "converting " << n << " values" << std::endl;
+  report("per element, unit lookup", time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = in[i] * find_unit(unit.data(), unit.size()).factor;
+    }
+  }), n);
+
+  report("per element, quantity", time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i) {
+      qout[i] = metres(qin[i]);
+    }
+  }), n);
+
+  Conversion toMetres;
+  if (!make_conversion(find_unit(unit.data(), unit.size()), find_unit("m", 1), toMetres)) {
+    return 1;
+  }
+  report("bulk, one thread", time_ms([&] {
+    convert(in.data(), out.data(), n, toMetres, 1);
+  }), n);
+
+  report("bulk, all threads", time_ms([&] {
+    convert(in.data(), out.data(), n, toMetres);
+  }), n);
+
+  report("bulk, quantity", time_ms([&] {
+    convert(qin.data(), qout.data(), n);
+  }), n);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    if (std::abs(out[i] - expected[i]) > 1e-12 ||
+        std::abs(qout[i].value() - expected[i]) > 1e-12) {
+      std::cerr << "mismatch at " << i << std::endl;
+      return 1;
+    }
+  }
+
+  const Conversion kelvinToFahrenheit = {1.8, -459.67};
+  const Conversion celsiusToFahrenheit = then(cCelsiusToKelvin, kelvinToFahrenheit);
+  report("bulk, chained with offset", time_ms([&] {
+    convert(in.data(), out.data(), n, celsiusToFahrenheit);
+  }), n);
+  if (std::abs(out[n / 2] - (in[n / 2] * 1.8 + 32.0)) > 1e-9) {
+    std::cerr << "chained conversion mismatch" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+// dyn_quantity - cost of runtime dimension checking
+//
+// Sums the kinetic energy 0.5 m v^2 of many particles held as raw
+// doubles, as boost::units quantities (checked at compile time) and as
+// dyn_quantity (checked at runtime), and checks that all agree.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Standard Library
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Third Party
+// - Boost
+#include "boost/units/systems/si.hpp"
+
+// This Project
+#include "DynQuantity.hpp"
+
+namespace {
+template <typename F>
+double time_ms(F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void report(const char* what, double ms, std::size_t n) {
+  std::cout << what << " : " << ms << " ms (" << 1e6 * ms / n << " ns/value)" << std::endl;
+}
+
+bool close(double a, double b) {
+  return std::abs(a - b) <= 1e-12 * std::abs(b);
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  using namespace warwick::units;
+  namespace si = boost::units::si;
+  const std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1u << 22;
+
+  std::vector<double> m(n), v(n);
+  std::vector<boost::units::quantity<si::mass> > sm(n);
+  std::vector<boost::units::quantity<si::velocity> > sv(n);
+  std::vector<dyn_quantity> dm(n), dv(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    m[i] = 1.0 + static_cast<double>(i % 7);
+    v[i] = 0.5 * static_cast<double>(i % 11);
+    sm[i] = m[i] * si::kilograms;
+    sv[i] = v[i] * si::meters_per_second;
+    dm[i] = sm[i];
+    dv[i] = sv[i];
+  }
+
+  std::cout << "summing kinetic energy of " << n << " particles" << std::endl;
+  double raw(0.0);
+  report("raw double", time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i) raw += 0.5 * m[i] * v[i] * v[i];
+  }), n);
+
+  boost::units::quantity<si::energy> stat(0.0 * si::joules);
+  report("boost::units quantity", time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i) stat += 0.5 * sm[i] * sv[i] * sv[i];
+  }), n);
+
+  dyn_quantity dyn(0.0, find_unit("J", 1));
+  report("dyn_quantity", time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i) dyn += 0.5 * dm[i] * dv[i] * dv[i];
+  }), n);
+
+  if (!close(stat.value(), raw) || !close(dyn.value(), raw) ||
+      dyn.dimension() != find_dimension("energy", 6)) {
+    std::cerr << "results differ" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+// unit_literals - unit expressions resolved to Boost.Units types at compile time
+//
+// Everything checked here is checked by the compiler; the program only
+// prints the values it computed. See UnitLiteral.hpp.
+//
+// Copyright (c) 2014 by Ben Morgan <bmorgan.warwick@gmail.com>
+// Copyright (c) 2014 by The University of Warwick
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Standard Library
+#include <iostream>
+#include <type_traits>
+
+// Third Party
+// - Boost
+#include "boost/units/io.hpp"
+
+// This Project
+#include "UnitLiteral.hpp"
+
+namespace {
+namespace si = boost::units::si;
+using namespace warwick::units::literals;
+
+// Dimensions
+static_assert(std::is_same<WARWICK_UNIT("m"), si::length>::value, "");
+static_assert(std::is_same<WARWICK_UNIT("kg m s^-2"), si::force>::value, "");
+static_assert(std::is_same<WARWICK_UNIT("  s^-1 m  "), si::velocity>::value, "");
+static_assert(std::is_same<WARWICK_UNIT("m m^-1"), si::dimensionless>::value, "");
+static_assert(std::is_same<WARWICK_UNIT("kg m^2 s^-3 A^-1"), si::electric_potential>::value, "");
+
+static_assert(std::is_same<WARWICK_UNIT("GeV ns^-1"), si::power>::value, "");
+static_assert(std::is_same<WARWICK_UNIT("uT"), si::magnetic_flux_density>::value, "");
+
+// Factors, from the prefix and unit tables
+static_assert("g"_unit.factor == 1e-3, "");
+static_assert("mm"_unit.factor == 1e-3, "");
+static_assert("kg"_unit.factor == 1.0, "");
+static_assert("h"_unit.factor == 3600.0, "");
+static_assert("g^2 m"_unit.factor == 1e-6, "");
+static_assert("kg^-1"_unit.dimension == warwick::units::make_dimension(0, -1), "");
+
+// Named dimensions
+static_assert(warwick::units::find_dimension("energy", 6) == "GeV"_unit.dimension, "");
+constexpr auto cForceExponents = warwick::units::exponents("kg m s^-2"_unit.dimension);
+static_assert(cForceExponents[warwick::units::time] == -2, "");
+
+// Exponents out of range do not carry into the next base dimension
+static_assert(!warwick::units::is_valid("m^127 m^127 m^2"_unit.dimension), "");
+static_assert(warwick::units::exponent("m^-128"_unit.dimension, warwick::units::length) == -128,
+              "");
+static_assert(!warwick::units::is_valid("m^128"_unit.dimension), "");
+static_assert(!warwick::units::is_valid("m^-129"_unit.dimension), "");
+// Both exponents parse, so only the product overflows
+static_assert(!warwick::units::is_valid("m^-128 m^-1"_unit.dimension), "");
+static_assert(warwick::units::exponent("m^127 m^-127 m"_unit.dimension, warwick::units::length) == 1,
+              "");
+static_assert(!warwick::units::is_valid("cd^100 cd^28"_unit.dimension), "");
+static_assert("kg m^2 s^-2 A K^-1 mol cd"_unit.dimension ==
+                  warwick::units::multiply(warwick::units::make_dimension(2, 1, -2, 1, -1),
+                                           warwick::units::make_dimension(0, 0, 0, 0, 0, 1, 1)),
+              "");
+
+// Invalid expressions, which are compile errors if used as types
+static_assert(!warwick::units::is_valid("furlong"_unit.dimension), "");
+static_assert(!warwick::units::is_valid("m^"_unit.dimension), "");
+static_assert(!warwick::units::is_valid("m^2s"_unit.dimension), "");
+static_assert(!warwick::units::is_valid(""_unit.dimension), "");
+
+constexpr auto cMass = WARWICK_QUANTITY(2.5, "g");
+static_assert(cMass.value() == 2.5e-3, "");
+}
+
+int main() {
+  const auto force = WARWICK_QUANTITY(3.0, "kg m s^-2");
+  const auto time = WARWICK_QUANTITY(2.0, "s");
+  std::cout << "force * time = " << force * time << std::endl;
+  std::cout << "mass = " << cMass << std::endl;
+  return 0;
+}
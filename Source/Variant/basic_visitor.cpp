@@ -10,6 +10,7 @@
 // Standard Library
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 // Third Party
 // - Boost